@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+
+# The MIT License (MIT)
+#
+# Copyright (c) 2018 Train IT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Full-build time of many translation units using the units library.
+
+Generates TUS translation units that use the standard time, length, velocity and frequency units and builds
+them in parallel in each of the following modes:
+
+    headers  every translation unit includes the library headers (the current header-only use)
+    pch      the headers are precompiled once (ref/module/units_pch.h) and every translation unit reuses them
+    module   the `units` C++20 module (ref/module/units.cppm) is built once and imported
+
+The one-off cost of building the precompiled header or the module interface is included in the total.
+The module mode compiles all modes as C++20 so that the numbers stay comparable.
+
+    build_bench.py --compiler g++ --modes headers pch
+    build_bench.py --compiler clang++ --modes headers pch module --tus 500
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+MODULE_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "module"))
+INCLUDE_DIR = os.path.normpath(os.path.join(MODULE_DIR, "..", "include"))
+
+MODES = ["headers", "pch", "module"]
+
+
+def generate_tu(index, mode):
+    """Returns the source of a translation unit with a typical use of the standard units."""
+    if mode == "module":
+        lines = ["import units;", "#include <cstdint>"]
+    else:
+        lines = ['#include "%s"' % os.path.join(INCLUDE_DIR, h).replace("\\", "/") for h in ("velocity.h", "frequency.h")]
+    lines += ["",
+              "namespace tu%d {" % index,
+              "",
+              "  using namespace units;",
+              "",
+              "  std::int64_t distance_m(std::int64_t km, std::int64_t m)",
+              "  {",
+              "    return quantity_cast<quantity<metre, std::int64_t>>(quantity<kilometre, std::int64_t>(km) +",
+              "                                                          quantity<metre, std::int64_t>(m)).count();",
+              "  }",
+              "",
+              "  long double speed_mps(long double km, long double h)",
+              "  {",
+              "    const quantity<kilometer_per_hour, long double> v = quantity<kilometre, long double>(km) /",
+              "                                                        quantity<hour, long double>(h);",
+              "    return quantity_cast<quantity<meter_per_second, long double>>(v).count();",
+              "  }",
+              "",
+              "  std::int64_t rate_mHz(std::int64_t events, std::int64_t ms)",
+              "  {",
+              "    const auto period = quantity<millisecond, std::int64_t>(ms) + quantity<second, std::int64_t>(%d);" % index,
+              "    return quantity_cast<quantity<millihertz, std::int64_t>>(events / period).count();",
+              "  }",
+              "",
+              "  static_assert(10_m / 5_s == 2_mps);",
+              "  static_assert(2_kmph * 2_h == 4_km);",
+              "  static_assert(10_Hz * 10_s == 100);",
+              "",
+              "}  // namespace tu%d" % index,
+              ""]
+    return "\n".join(lines)
+
+
+def compiler_kind(compiler):
+    out = subprocess.run([compiler, "--version"], stdout=subprocess.PIPE, universal_newlines=True).stdout
+    return "clang" if "clang" in out else "gcc"
+
+
+def run_compiler(cmd, cwd):
+    proc = subprocess.run(cmd, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if proc.returncode != 0:
+        # the first diagnostics are enough to tell why a mode is not supported
+        raise RuntimeError("%s\n%s" % (" ".join(cmd), "\n".join(proc.stdout.splitlines()[:10])))
+
+
+def prepare(compiler, kind, mode, std, workdir):
+    """Builds the one-off artifact of 'mode' and returns the extra flags of the translation units."""
+    if mode == "headers":
+        return []
+    if mode == "pch":
+        # the precompiled header has to live next to the header that is force-included
+        header = os.path.join(workdir, "units_pch.h")
+        with open(header, "w") as f:
+            f.write('#include "%s"\n' % os.path.join(MODULE_DIR, "units_pch.h").replace("\\", "/"))
+        if kind == "clang":
+            run_compiler([compiler, std, "-x", "c++-header", header, "-o", header + ".pch"], workdir)
+            return ["-include-pch", header + ".pch"]
+        run_compiler([compiler, std, "-x", "c++-header", header, "-o", header + ".gch"], workdir)
+        return ["-include", header]
+    # module
+    interface = os.path.join(MODULE_DIR, "units.cppm")
+    if kind == "clang":
+        bmi = os.path.join(workdir, "units.pcm")
+        run_compiler([compiler, std, "--precompile", "-x", "c++-module", interface, "-o", bmi], workdir)
+        run_compiler([compiler, std, "-c", bmi, "-o", os.path.join(workdir, "units_module.o")], workdir)
+        return ["-fmodule-file=units=" + bmi]
+    run_compiler([compiler, std, "-fmodules-ts", "-x", "c++", "-c", interface, "-o",
+                  os.path.join(workdir, "units_module.o")], workdir)
+    return ["-fmodules-ts"]
+
+
+def build(compiler, kind, mode, std, tus, jobs):
+    """Returns (one-off seconds, translation units seconds) of a full build in 'mode'."""
+    with tempfile.TemporaryDirectory() as workdir:
+        sources = []
+        for i in range(tus):
+            src = os.path.join(workdir, "tu%d.cpp" % i)
+            with open(src, "w") as f:
+                f.write(generate_tu(i, mode))
+            sources.append(src)
+
+        start = time.perf_counter()
+        flags = prepare(compiler, kind, mode, std, workdir)
+        prepared = time.perf_counter()
+        with ThreadPoolExecutor(max_workers=jobs) as pool:
+            list(pool.map(lambda src: run_compiler([compiler, std] + flags + ["-c", src, "-o", src + ".o"], workdir),
+                          sources))
+        return prepared - start, time.perf_counter() - prepared
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--modes", nargs="+", choices=MODES, default=["headers", "pch"])
+    parser.add_argument("--tus", type=int, default=200, help="number of translation units (default 200)")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+
+    kind = compiler_kind(args.compiler)
+    std = "-std=c++20" if "module" in args.modes else "-std=c++17"
+    print("%d translation units, %d jobs, %s" % (args.tus, args.jobs, std))
+
+    reference = None
+    for mode in args.modes:
+        try:
+            runs = [build(args.compiler, kind, mode, std, args.tus, args.jobs) for _ in range(args.repeat)]
+        except RuntimeError as e:
+            print("%-8s not supported by %s:\n%s" % (mode, args.compiler, e))
+            continue
+        once, tus = min(runs, key=sum)
+        total = once + tus
+        reference = reference or total
+        print("%-8s %8.2f s  (one-off %6.2f s, translation units %7.2f s)  %5.2fx" %
+              (mode, total, once, tus, reference / total))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+
+# The MIT License (MIT)
+#
+# Copyright (c) 2018 Train IT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Object-size check of the explicit instantiation catalogue (ref/include/quantity_catalogue.h).
+
+Compiles the same translation unit once including the library headers and once including the catalogue,
+compares the sizes of the resulting objects and links both against ref/src/quantity_catalogue.cpp to make
+sure every declared instantiation is defined and both programs compute the same results. Fails if the
+catalogue does not make the object smaller at the given optimization level. With optimizations enabled the
+members are mostly inlined anyway, so the check is meant for unoptimized (debug) builds.
+
+    catalogue_size.py --compiler g++ --opt=-O0
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+REF_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+SOURCE = r"""
+#ifdef USE_CATALOGUE
+#include "quantity_catalogue.h"
+#else
+#include "frequency.h"
+#include "velocity.h"
+#endif
+#include <cstdio>
+
+using namespace units;
+
+quantity<metre, std::int64_t> distance(quantity<kilometre, std::int64_t> km, quantity<metre, std::int64_t> m)
+{
+  quantity<metre, std::int64_t> d = km;
+  d += m;
+  ++d;
+  return -d;
+}
+
+quantity<second, double> elapsed(quantity<hour, double> h, quantity<millisecond, double> ms)
+{
+  quantity<second, double> t = h;
+  t -= quantity<second, double>(ms);
+  t *= 2.0;
+  return t;
+}
+
+quantity<meter_per_second, long double> speed(quantity<kilometer_per_hour, long double> v)
+{
+  quantity<meter_per_second, long double> s = v;
+  s /= 3.0L;
+  return s;
+}
+
+quantity<hertz, std::int64_t> frequency(quantity<kilohertz, std::int64_t> f)
+{
+  quantity<hertz, std::int64_t> hz = f;
+  return hz - quantity<hertz, std::int64_t>::zero();
+}
+
+int main()
+{
+  std::printf("%lld %f %Lf %lld\n",
+              static_cast<long long>(distance(quantity<kilometre, std::int64_t>(3),
+                                              quantity<metre, std::int64_t>(14)).count()),
+              elapsed(quantity<hour, double>(1.5), quantity<millisecond, double>(250)).count(),
+              speed(quantity<kilometer_per_hour, long double>(36)).count(),
+              static_cast<long long>(frequency(quantity<kilohertz, std::int64_t>(7)).count()));
+}
+"""
+
+
+def run(cmd, **kwargs):
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True, **kwargs)
+    if proc.returncode != 0:
+        sys.exit("%s\n%s" % (" ".join(cmd), proc.stdout))
+    return proc.stdout
+
+
+def text_size(obj):
+    """Returns the size of the .text section(s) as reported by size(1)."""
+    out = run(["size", obj]).splitlines()
+    return int(out[1].split()[0])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--opt", default="-O0", help="optimization level (default -O0)")
+    args = parser.parse_args()
+
+    flags = [args.compiler, "-std=c++17", args.opt, "-I" + os.path.join(REF_DIR, "include")]
+    with tempfile.TemporaryDirectory() as workdir:
+        src = os.path.join(workdir, "sizes.cpp")
+        with open(src, "w") as f:
+            f.write(SOURCE)
+        catalogue = os.path.join(workdir, "quantity_catalogue.o")
+        run(flags + ["-c", os.path.join(REF_DIR, "src", "quantity_catalogue.cpp"), "-o", catalogue])
+
+        sizes, outputs = {}, {}
+        for name, defines in (("headers", []), ("catalogue", ["-DUSE_CATALOGUE"])):
+            obj = os.path.join(workdir, name + ".o")
+            exe = os.path.join(workdir, name)
+            run(flags + defines + ["-c", src, "-o", obj])
+            run([args.compiler, obj, catalogue, "-o", exe])
+            sizes[name] = text_size(obj)
+            outputs[name] = run([exe])
+
+    print("%s .text: headers %d B, catalogue %d B (%.1f%%)" %
+          (args.opt, sizes["headers"], sizes["catalogue"], 100.0 * sizes["catalogue"] / sizes["headers"]))
+    if outputs["headers"] != outputs["catalogue"]:
+        sys.exit("results differ: %r != %r" % (outputs["headers"], outputs["catalogue"]))
+    if sizes["catalogue"] >= sizes["headers"]:
+        sys.exit("the catalogue did not reduce the object size")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+
+# The MIT License (MIT)
+#
+# Copyright (c) 2018 Train IT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Code-generation check of the std::chrono interoperability (ref/include/quantity_chrono.h).
+
+Compiles functions converting between time quantities and std::chrono::duration with the same representation and
+ratio (in both directions and as a round trip through both types) to assembly next to a function returning its
+argument unchanged. Fails if any of them emits an instruction that the identity function does not, i.e. if a
+same-ratio conversion is not a no-op. Different-ratio conversions are compiled as well to make sure the check
+would notice a conversion that does work.
+
+    chrono_codegen.py --compiler g++ --opt=-O2
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+REF_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+SOURCE = r"""
+#include "quantity_chrono.h"
+#include <cstdint>
+
+using namespace units;
+
+extern "C" {
+
+std::int64_t identity(std::int64_t v) { return v; }
+
+std::int64_t ns_to_quantity(std::chrono::nanoseconds d) { return quantity<nanosecond, std::int64_t>(d).count(); }
+std::int64_t ms_to_quantity(std::chrono::milliseconds d) { return quantity<millisecond, std::int64_t>(d).count(); }
+std::int64_t s_to_quantity(std::chrono::seconds d) { return quantity<second, std::int64_t>(d).count(); }
+std::int64_t ns_to_duration(quantity<nanosecond, std::int64_t> q) { return std::chrono::nanoseconds(q).count(); }
+std::int64_t ms_to_duration(quantity<millisecond, std::int64_t> q) { return std::chrono::milliseconds(q).count(); }
+std::int64_t s_to_duration(quantity<second, std::int64_t> q) { return std::chrono::seconds(q).count(); }
+std::int64_t as_duration_ns(quantity<nanosecond, std::int64_t> q) { return as_duration(q).count(); }
+std::int64_t as_quantity_ms(std::chrono::milliseconds d) { return as_quantity(d).count(); }
+
+std::int64_t round_trip_ns(std::int64_t v)
+{
+  const std::chrono::nanoseconds d = quantity<nanosecond, std::int64_t>(v);
+  const quantity<nanosecond, std::int64_t> q = d;
+  return q.count();
+}
+
+// different ratios: must not match the identity
+std::int64_t s_to_ms_quantity(std::chrono::seconds d) { return quantity<millisecond, std::int64_t>(d).count(); }
+std::int64_t ns_to_us_duration(quantity<nanosecond, std::int64_t> q)
+{
+  return std::chrono::microseconds(quantity_cast<quantity<microsecond, std::int64_t>>(q)).count();
+}
+
+}
+"""
+
+SCALING = ("s_to_ms_quantity", "ns_to_us_duration")
+
+
+def run(cmd, **kwargs):
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True, **kwargs)
+    if proc.returncode != 0:
+        sys.exit("%s\n%s" % (" ".join(cmd), proc.stdout))
+    return proc.stdout
+
+
+def functions(asm):
+    """Returns the instructions of every function in the assembly listing, without labels and directives."""
+    bodies, current = {}, None
+    for line in asm.splitlines():
+        label = re.match(r"^([A-Za-z_][A-Za-z0-9_]*):", line)
+        if label:
+            current = bodies.setdefault(label.group(1), [])
+        elif current is not None and line.startswith("\t") and not line.lstrip().startswith("."):
+            current.append(" ".join(line.split()))
+    return {name: body for name, body in bodies.items() if body}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--opt", default="-O2", help="optimization level (default -O2)")
+    args = parser.parse_args()
+
+    # time.h would shadow the C library header with -I
+    flags = [args.compiler, "-std=c++17", args.opt, "-fno-asynchronous-unwind-tables", "-fno-exceptions",
+             "-iquote", os.path.join(REF_DIR, "include")]
+    with tempfile.TemporaryDirectory() as workdir:
+        src = os.path.join(workdir, "chrono.cpp")
+        with open(src, "w") as f:
+            f.write(SOURCE)
+        asm = os.path.join(workdir, "chrono.s")
+        run(flags + ["-S", src, "-o", asm])
+        with open(asm) as f:
+            bodies = functions(f.read())
+
+    identity = bodies.pop("identity")
+    failures = []
+    for name, body in sorted(bodies.items()):
+        print("%-20s %s" % (name, "no-op" if body == identity else "%d instruction(s)" % len(body)))
+        if (body == identity) == (name in SCALING):
+            failures.append(name)
+    if failures:
+        sys.exit("unexpected code generated for: %s" % ", ".join(failures))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+
+# The MIT License (MIT)
+#
+# Copyright (c) 2018 Train IT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Compile-time scaling benchmark of the dimension algebra.
+
+Generates translation units with N base dimensions and a chain of DEPTH alternating
+dimension_multiply/dimension_divide steps, compiles each of them and records the compile wall
+time and the peak memory of the compiler. With clang the number of template instantiations is
+taken from -ftime-trace, with GCC the time and memory spent in template instantiation from
+-ftime-report. Results can be stored as a baseline and later checked against it.
+
+    dimension_bench.py --compiler g++ --write-baseline baseline.json
+    dimension_bench.py --compiler g++ --check baseline.json
+"""
+
+import argparse
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+INCLUDE_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "include"))
+
+DEFAULT_DIMENSIONS = [3, 7, 12, 20]
+DEFAULT_DEPTHS = [8, 32]
+
+# metric -> absolute difference below which a change is treated as measurement noise
+METRICS = {"wall_time_s": 0.05, "peak_memory_kb": 2048, "instantiations": 0, "instantiation_time_s": 0.05,
+           "instantiation_memory_kb": 2048}
+
+
+def generate_tu(dimensions, depth):
+    """Returns the source of a translation unit exercising the dimension algebra."""
+    lines = ['#include "%s"' % os.path.join(INCLUDE_DIR, "dimension.h").replace("\\", "/"), "",
+             "namespace bench {", "", "  using namespace units;", ""]
+    lines += ["  struct d%d : dim_id<%d> {};" % (i, i) for i in range(dimensions)]
+    lines.append("")
+
+    # all base dimensions in reverse order so that make_dimension has to sort them
+    exps = ", ".join("exp<d%d, %d>" % (i, i + 1) for i in reversed(range(dimensions)))
+    lines.append("  using r0 = make_dimension<%s>;" % exps)
+
+    # every step uses different exponents so that no instantiation is reused between steps
+    for step in range(1, depth + 1):
+        first, second = step % dimensions, (step * 7 + 3) % dimensions
+        factor = "make_dimension<exp<d%d, %d>, exp<d%d, %d>>" % (first, step + 1, second, -(step + 2))
+        op = "dimension_multiply" if step % 2 else "dimension_divide"
+        lines.append("  using r%d = %s<r%d, %s>;" % (step, op, step - 1, factor))
+
+    lines += ["", "  static_assert(is_dimension<r%d>);" % depth, "", "}  // namespace bench", ""]
+    return "\n".join(lines)
+
+
+def compiler_kind(compiler):
+    out = subprocess.run([compiler, "--version"], stdout=subprocess.PIPE, universal_newlines=True).stdout
+    if "clang" in out:
+        return "clang"
+    if "GCC" in out or "g++" in out or "Free Software Foundation" in out:
+        return "gcc"
+    return None
+
+
+def count_instantiations(trace_file):
+    with open(trace_file) as f:
+        events = json.load(f).get("traceEvents", [])
+    return sum(1 for e in events if e.get("name") in ("InstantiateClass", "InstantiateFunction"))
+
+
+def parse_time_report(output):
+    """Extracts the 'template instantiation' wall time and GGC memory from GCC's -ftime-report."""
+    units = {"k": 1, "M": 1024, "G": 1024 * 1024}
+    for line in output.splitlines():
+        if line.strip().startswith("template instantiation"):
+            fields = re.findall(r"([0-9.]+)\s*\(\s*\d+%\)|([0-9.]+)([kMG])\s*\(", line)
+            times = [float(t) for t, _, _ in fields if t]
+            memory = [int(float(m) * units[u]) for _, m, u in fields if m]
+            return {"instantiation_time_s": times[2] if len(times) > 2 else None,
+                    "instantiation_memory_kb": memory[0] if memory else None}
+    return {}
+
+
+def compile_tu(compiler, kind, source, workdir):
+    src = os.path.join(workdir, "tu.cpp")
+    obj = os.path.join(workdir, "tu.o")
+    with open(src, "w") as f:
+        f.write(source)
+    cmd = [compiler, "-std=c++17", "-c", src, "-o", obj]
+    if kind == "clang":
+        cmd.append("-ftime-trace")
+    elif kind == "gcc":
+        cmd.append("-ftime-report")
+
+    # wait4() reports the resource usage of this compiler invocation only (including its sub-processes)
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    output = proc.stdout.read()
+    proc.stdout.close()
+    _, status, usage = os.wait4(proc.pid, 0)
+    elapsed = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode != 0:
+        sys.exit("compilation failed:\n" + output)
+
+    peak = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    measurement = {"wall_time_s": round(elapsed, 3), "peak_memory_kb": peak}
+    if kind == "clang":
+        measurement["instantiations"] = count_instantiations(os.path.join(workdir, "tu.json"))
+    elif kind == "gcc":
+        measurement.update(parse_time_report(output))
+    return measurement
+
+
+def run(compiler, dimensions, depths, repeat):
+    kind = compiler_kind(compiler)
+    results = []
+    with tempfile.TemporaryDirectory() as workdir:
+        for n in dimensions:
+            for depth in depths:
+                source = generate_tu(n, depth)
+                runs = [compile_tu(compiler, kind, source, workdir) for _ in range(repeat)]
+                best = min(runs, key=lambda r: r["wall_time_s"])
+                best.update({"dimensions": n, "depth": depth})
+                results.append(best)
+                details = ", ".join("%s=%s" % (k, v) for k, v in best.items()
+                                    if k not in ("dimensions", "depth", "wall_time_s", "peak_memory_kb"))
+                print("N=%-3d depth=%-4d %8.3f s %10d kB  %s" %
+                      (n, depth, best["wall_time_s"], best["peak_memory_kb"], details))
+    return results
+
+
+def compiler_version(compiler):
+    out = subprocess.run([compiler, "--version"], stdout=subprocess.PIPE, universal_newlines=True).stdout
+    return out.splitlines()[0] if out else compiler
+
+
+def check(results, baseline, tolerance):
+    """Returns the list of regressions of 'results' against 'baseline'."""
+    regressions = []
+    reference = {(r["dimensions"], r["depth"]): r for r in baseline["results"]}
+    for r in results:
+        base = reference.get((r["dimensions"], r["depth"]))
+        if base is None:
+            continue
+        for key, noise in METRICS.items():
+            if r.get(key) and base.get(key) and r[key] > base[key] * (1 + tolerance) and r[key] - base[key] > noise:
+                regressions.append("N=%d depth=%d: %s %s > baseline %s" %
+                                   (r["dimensions"], r["depth"], key, r[key], base[key]))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--dimensions", type=int, nargs="+", default=DEFAULT_DIMENSIONS)
+    parser.add_argument("--depths", type=int, nargs="+", default=DEFAULT_DEPTHS)
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--write-baseline", metavar="FILE")
+    parser.add_argument("--check", metavar="FILE", help="fail if any metric regressed against the baseline")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="allowed relative regression (default 0.25)")
+    parser.add_argument("--print-tu", nargs=2, type=int, metavar=("N", "DEPTH"), help="print a generated TU and exit")
+    args = parser.parse_args()
+
+    if args.print_tu:
+        print(generate_tu(*args.print_tu))
+        return 0
+
+    results = run(args.compiler, args.dimensions, args.depths, args.repeat)
+
+    if args.write_baseline:
+        with open(args.write_baseline, "w") as f:
+            json.dump({"compiler": compiler_version(args.compiler), "machine": platform.machine(), "results": results},
+                      f, indent=2)
+            f.write("\n")
+
+    if args.check:
+        with open(args.check) as f:
+            baseline = json.load(f)
+        # the first word is just the name the compiler was invoked with (c++, g++, ...)
+        if baseline.get("compiler", "").split(" ", 1)[-1] != compiler_version(args.compiler).split(" ", 1)[-1]:
+            print("warning: baseline was recorded with '%s'" % baseline.get("compiler"))
+        regressions = check(results, baseline, args.tolerance)
+        for r in regressions:
+            print("REGRESSION " + r)
+        return 1 if regressions else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
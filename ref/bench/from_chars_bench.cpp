@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/quantity_charconv.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t size = 1 << 20;
+
+  // values like "12.5 km", "300mm" or "7.125 m" stored back to back
+  struct input {
+    std::string buffer;
+    std::vector<std::pair<std::size_t, std::size_t>> values;  // offset, length
+  };
+
+  input make_input(bool fractions)
+  {
+    static const char* const symbols[] = {"mm", "m", "km"};
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<int> number(0, 999'999);
+    std::uniform_int_distribution<int> fraction(0, 999);
+    std::uniform_int_distribution<int> symbol(0, 2);
+    std::bernoulli_distribution space;
+
+    input in;
+    char str[32];
+    for(std::size_t i = 0; i < size; ++i) {
+      const int n = fractions ? std::snprintf(str, sizeof(str), "%d.%03d%s%s", number(gen), fraction(gen),
+                                              space(gen) ? " " : "", symbols[symbol(gen)])
+                              : std::snprintf(str, sizeof(str), "%d%s%s", number(gen), space(gen) ? " " : "",
+                                              symbols[symbol(gen)]);
+      in.values.emplace_back(in.buffer.size(), static_cast<std::size_t>(n));
+      in.buffer.append(str, static_cast<std::size_t>(n));
+    }
+    return in;
+  }
+
+  // the hand-rolled mapping: std::stod and a lookup of the conversion factor by the symbol
+  double stod_lookup(const char* first, const char* last)
+  {
+    static const std::unordered_map<std::string, double> factors = {{"mm", 0.001}, {"m", 1.0}, {"km", 1000.0}};
+    std::size_t pos = 0;
+    const std::string str(first, last);
+    const double value = std::stod(str, &pos);
+    while(pos < str.size() && str[pos] == ' ') ++pos;
+    return value * factors.at(str.substr(pos));
+  }
+
+  template<typename T, typename F>
+  void run(const char* name, const input& in, F f)
+  {
+    std::vector<T> out(in.values.size());
+    const double ns = bench::run(name, in.values.size(), [&] {
+      for(std::size_t i = 0; i < in.values.size(); ++i) {
+        const char* first = in.buffer.data() + in.values[i].first;
+        out[i] = f(first, first + in.values[i].second);
+      }
+      bench::do_not_optimize(out.data());
+    });
+    std::printf("%-48s %10.1f M values/s\n", "", 1e3 / ns);
+  }
+
+  template<typename Q>
+  typename Q::rep parse(const char* first, const char* last)
+  {
+    Q q;
+    from_chars(first, last, q);
+    return q.count();
+  }
+
+}  // namespace
+
+int main()
+{
+  const auto fractions = make_input(true);
+  std::printf("\"123456.789 km\"-like values, %zu MB\n", fractions.buffer.size() >> 20);
+  run<double>("std::stod + lookup -> metre, double", fractions, stod_lookup);
+  run<double>("from_chars -> metre, double", fractions, parse<quantity<metre, double>>);
+  run<std::int64_t>("from_chars -> millimetre, int64_t", fractions, parse<quantity<millimetre, std::int64_t>>);
+
+  const auto integers = make_input(false);
+  std::printf("\"123456 km\"-like values, %zu MB\n", integers.buffer.size() >> 20);
+  run<double>("std::stod + lookup -> metre, double", integers, stod_lookup);
+  run<double>("from_chars -> metre, double", integers, parse<quantity<metre, double>>);
+  run<std::int64_t>("from_chars -> millimetre, int64_t", integers, parse<quantity<millimetre, std::int64_t>>);
+}
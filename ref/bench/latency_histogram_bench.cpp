@@ -0,0 +1,119 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/latency_histogram.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t size = 1 << 23;
+
+  using latency = quantity<nanosecond, std::int64_t>;
+
+  // the ad-hoc approach: hand-picked bucket bounds in raw nanoseconds searched one by one
+  struct bucket_array {
+    static constexpr std::int64_t bounds[] = {
+        1'000,      2'000,      5'000,      10'000,      20'000,      50'000,      100'000,      200'000,
+        500'000,    1'000'000,  2'000'000,  5'000'000,   10'000'000,  20'000'000,  50'000'000,   100'000'000,
+        200'000'000, 500'000'000, 1'000'000'000, 2'000'000'000, 5'000'000'000, 10'000'000'000};
+    std::uint64_t counts[std::size(bounds) + 1] = {};
+
+    void record(std::int64_t ns)
+    {
+      std::size_t i = 0;
+      while(i < std::size(bounds) && ns >= bounds[i]) ++i;
+      ++counts[i];
+    }
+
+    // the upper bound of the bucket holding the given percentile
+    std::int64_t percentile(double percent) const
+    {
+      std::uint64_t total = 0;
+      for(auto c : counts) total += c;
+      const auto rank = static_cast<std::uint64_t>(percent / 100 * static_cast<double>(total));
+      std::uint64_t seen = 0;
+      for(std::size_t i = 0; i < std::size(bounds); ++i)
+        if((seen += counts[i]) > rank) return bounds[i];
+      return bounds[std::size(bounds) - 1];
+    }
+  };
+
+}  // namespace
+
+int main()
+{
+  std::mt19937_64 gen(42);
+  std::lognormal_distribution<double> dist(11, 1.2);  // ~60 us median with a long tail
+  std::vector<latency> samples(size);
+  for(auto& s : samples) s = latency(static_cast<std::int64_t>(dist(gen)));
+
+  bucket_array adhoc;
+  latency_histogram<> hdr;
+  bench::run("ad-hoc bucket array, linear search", size, [&] {
+    adhoc = bucket_array();
+    for(const latency& s : samples) adhoc.record(s.count());
+    bench::do_not_optimize(adhoc);
+  });
+  bench::run("latency_histogram::record", size, [&] {
+    hdr.reset();
+    for(const latency& s : samples) hdr.record(s);
+    bench::do_not_optimize(hdr);
+  });
+
+  latency_histogram<> shared;
+  bench::run("4 threads record + merge into shared", size, [&] {
+    shared.reset();
+    std::vector<std::thread> pool;
+    for(std::size_t t = 0; t < 4; ++t)
+      pool.emplace_back([&, t] {
+        latency_histogram<> local;
+        for(std::size_t i = t * size / 4; i < (t + 1) * size / 4; ++i) local.record(samples[i]);
+        shared.merge(local);
+      });
+    for(auto& t : pool) t.join();
+  }, 3);
+
+  std::vector<latency> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  std::printf("%-8s %14s %14s %14s\n", "", "exact", "bucket array", "histogram");
+  for(double p : {50.0, 90.0, 99.0, 99.9}) {
+    const auto exact = sorted[static_cast<std::size_t>(p / 100 * (size - 1))];
+    std::printf("p%-7g %11.3f us %11.3f us %11.3f us\n", p, quantity_cast<quantity<microsecond, double>>(exact).count(),
+                static_cast<double>(adhoc.percentile(p)) / 1000,
+                hdr.percentile<quantity<microsecond, double>>(p).count());
+  }
+  constexpr std::size_t hdr7 = sizeof(latency_histogram<>) + latency_histogram<>::bucket_count * sizeof(std::uint64_t);
+  constexpr std::size_t hdr4 =
+      sizeof(latency_histogram<nanosecond, 4>) + latency_histogram<nanosecond, 4>::bucket_count * sizeof(std::uint64_t);
+  std::printf("memory: bucket array %zu B, latency_histogram<> %zu B, latency_histogram<nanosecond, 4> %zu B, "
+              "all samples %zu B\n",
+              sizeof(bucket_array), hdr7, hdr4, size * sizeof(latency));
+}
@@ -0,0 +1,204 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/velocity.h"
+#include "../include/quantity_array.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  // lengths up to two AVX-512 vectors of the narrowest rep plus a tail of every length
+  constexpr std::size_t max_checked_size = 2 * 64 / sizeof(std::int32_t) + 16;
+
+  std::size_t failures = 0;
+
+  template<typename T>
+  void expect_equal(const char* what, std::size_t n, std::size_t i, const T& actual, const T& expected)
+  {
+    if(actual == expected) return;
+    if(failures++ < 10) std::printf("MISMATCH %s, size %zu, element %zu\n", what, n, i);
+  }
+
+  template<typename Range, typename F>
+  void check_elements(const char* what, const Range& actual, std::size_t n, F expected)
+  {
+    if(actual.size() != n) {
+      if(failures++ < 10) std::printf("MISMATCH %s, size %zu != %zu\n", what, actual.size(), n);
+      return;
+    }
+    for(std::size_t i = 0; i < n; ++i) expect_equal(what, n, i, actual[i], expected(i));
+  }
+
+  template<typename T>
+  T random_value(std::mt19937_64& gen)
+  {
+    // never zero, so that every value can be a divisor
+    if constexpr(std::is_integral_v<T>)
+      return static_cast<T>(std::uniform_int_distribution<int>(1, 1000)(gen) * (gen() % 2 ? 1 : -1));
+    else
+      return static_cast<T>(std::uniform_real_distribution<double>(0.5, 1000)(gen) * (gen() % 2 ? 1 : -1));
+  }
+
+  // every elementwise operator against the scalar quantity operators, on all lengths up to max_checked_size
+  template<typename T>
+  void check_operators(const char* rep)
+  {
+    std::mt19937_64 gen(42);
+    const T k = random_value<T>(gen);
+    for(std::size_t n = 0; n <= max_checked_size; ++n) {
+      quantity_array<metre, T> a(n), b(n);
+      quantity_array<second, T> t(n);
+      for(std::size_t i = 0; i < n; ++i) {
+        a[i] = quantity<metre, T>(random_value<T>(gen));
+        b[i] = quantity<metre, T>(random_value<T>(gen));
+        t[i] = quantity<second, T>(random_value<T>(gen));
+      }
+      check_elements("a + b", a + b, n, [&](std::size_t i) { return a[i] + b[i]; });
+      check_elements("a - b", a - b, n, [&](std::size_t i) { return a[i] - b[i]; });
+      check_elements("a * t", a * t, n, [&](std::size_t i) { return a[i] * t[i]; });
+      check_elements("a / t", a / t, n, [&](std::size_t i) { return a[i] / t[i]; });
+      check_elements("a * k", a * k, n, [&](std::size_t i) { return a[i] * k; });
+      check_elements("k * a", k * a, n, [&](std::size_t i) { return k * a[i]; });
+      check_elements("a / k", a / k, n, [&](std::size_t i) { return a[i] / k; });
+      check_elements("k / t", k / t, n, [&](std::size_t i) { return k / t[i]; });
+
+      quantity_array<kilometre, T> km(n);
+      quantity_cast(a, quantity_span<quantity<kilometre, T>>(km));
+      check_elements("quantity_cast", km, n, [&](std::size_t i) { return quantity_cast<quantity<kilometre, T>>(a[i]); });
+      const quantity_array<metre, T> copy = a;
+      const auto in_place = quantity_cast<quantity<millimetre, T>>(a);
+      check_elements("in-place quantity_cast", in_place, n,
+                     [&](std::size_t i) { return quantity_cast<quantity<millimetre, T>>(copy[i]); });
+    }
+
+    bool thrown = false;
+    try {
+      bench::do_not_optimize(quantity_array<metre, T>(3) + quantity_array<metre, T>(4));
+    }
+    catch(const std::system_error&) {
+      thrown = true;
+    }
+    if(!thrown && failures++ < 10) std::printf("MISMATCH operands of different lengths were accepted\n");
+    std::printf("%s operators: checked\n", rep);
+  }
+
+#if defined(UNITS_SIMD_X86)
+  // the operators use the widest supported ISA only; the narrower kernels are compared with the scalar one directly
+  template<detail::simd::op O, bool LhsScalar, bool RhsScalar, typename T>
+  void check_kernels(const char* what, const std::vector<T>& lhs, const std::vector<T>& rhs)
+  {
+    namespace simd = detail::simd;
+    const bool avx2 = __builtin_cpu_supports("avx2");
+    const bool avx512 = __builtin_cpu_supports("avx512f");
+    for(std::size_t n = 0; n <= lhs.size(); ++n) {
+      std::vector<T> expected(n), actual(n);
+      simd::transform_scalar<O, LhsScalar, RhsScalar>(lhs.data(), rhs.data(), expected.data(), n);
+      auto same = [&](std::size_t i) { return expected[i]; };
+      simd::transform_sse2<O, LhsScalar, RhsScalar>(lhs.data(), rhs.data(), actual.data(), n);
+      check_elements(what, actual, n, same);
+      if(avx2) {
+        simd::transform_avx2<O, LhsScalar, RhsScalar>(lhs.data(), rhs.data(), actual.data(), n);
+        check_elements(what, actual, n, same);
+      }
+      if(avx512) {
+        simd::transform_avx512<O, LhsScalar, RhsScalar>(lhs.data(), rhs.data(), actual.data(), n);
+        check_elements(what, actual, n, same);
+      }
+    }
+  }
+
+  template<detail::simd::op O, typename T>
+  void check_kernels(const char* what, const std::vector<T>& lhs, const std::vector<T>& rhs)
+  {
+    check_kernels<O, false, false>(what, lhs, rhs);
+    check_kernels<O, false, true>(what, lhs, rhs);
+    check_kernels<O, true, false>(what, lhs, rhs);
+  }
+
+  template<typename T>
+  void check_kernels(const char* rep)
+  {
+    std::mt19937_64 gen(7);
+    std::vector<T> lhs(max_checked_size), rhs(max_checked_size);
+    for(std::size_t i = 0; i < max_checked_size; ++i) {
+      lhs[i] = random_value<T>(gen);
+      rhs[i] = random_value<T>(gen);
+    }
+    check_kernels<detail::simd::op::add>("add kernel", lhs, rhs);
+    check_kernels<detail::simd::op::sub>("sub kernel", lhs, rhs);
+    check_kernels<detail::simd::op::mul>("mul kernel", lhs, rhs);
+    check_kernels<detail::simd::op::div>("div kernel", lhs, rhs);
+    std::printf("%s kernels: checked\n", rep);
+  }
+#endif
+
+  template<typename T>
+  void run(const char* name)
+  {
+    constexpr std::size_t size = 1 << 16;
+    std::mt19937_64 gen(42);
+    quantity_array<metre, T> a(size), b(size);
+    for(std::size_t i = 0; i < size; ++i) {
+      a[i] = quantity<metre, T>(random_value<T>(gen));
+      b[i] = quantity<metre, T>(random_value<T>(gen));
+    }
+    std::vector<quantity<metre, T>> out(size);
+    std::printf("%s\n", name);
+    bench::run("  scalar loop a + b", size, [&] {
+      for(std::size_t i = 0; i < size; ++i) out[i] = a[i] + b[i];
+      bench::do_not_optimize(out.data());
+    }, 100);
+    bench::run("  quantity_array a + b", size, [&] {
+      const auto r = a + b;
+      bench::do_not_optimize(r.data());
+    }, 100);
+  }
+
+}  // namespace
+
+int main()
+{
+  check_operators<std::int32_t>("int32_t");
+  check_operators<std::int64_t>("int64_t");
+  check_operators<float>("float");
+  check_operators<double>("double");
+#if defined(UNITS_SIMD_X86)
+  check_kernels<std::int32_t>("int32_t");
+  check_kernels<std::int64_t>("int64_t");
+  check_kernels<float>("float");
+  check_kernels<double>("double");
+#endif
+  if(failures != 0) {
+    std::printf("%zu mismatches\n", failures);
+    return 1;
+  }
+
+  run<std::int32_t>("int32_t");
+  run<double>("double");
+}
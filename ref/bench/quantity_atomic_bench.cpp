@@ -0,0 +1,86 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/quantity_atomic.h"
+#include "../include/time.h"
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t increments = 1 << 22;
+
+  using busy_time = quantity<nanosecond, std::int64_t>;
+  using sample = quantity<microsecond, std::int64_t>;
+
+  struct locked_counter {
+    std::mutex m;
+    busy_time value{};
+    void add(const sample& s)
+    {
+      std::lock_guard<std::mutex> lock(m);
+      value += s;
+    }
+  };
+
+  struct atomic_counter {
+    std::atomic<busy_time> value{busy_time{}};
+    void add(const sample& s) { value.fetch_add(s, std::memory_order_relaxed); }
+  };
+
+  // 'threads' threads share 'increments' additions of 1 us; returns the busy time seen at the end
+  template<typename Counter>
+  std::int64_t contend(Counter& counter, unsigned threads)
+  {
+    std::vector<std::thread> pool;
+    for(unsigned t = 0; t < threads; ++t)
+      pool.emplace_back([&counter, n = increments / threads] {
+        for(std::size_t i = 0; i < n; ++i) counter.add(sample(1));
+      });
+    for(auto& t : pool) t.join();
+    return busy_time(counter.value).count();
+  }
+
+}  // namespace
+
+int main()
+{
+  char name[64];
+  for(unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+    std::snprintf(name, sizeof(name), "std::mutex, %u threads", threads);
+    bench::run(name, increments, [&] {
+      locked_counter c;
+      bench::do_not_optimize(contend(c, threads));
+    }, 3);
+    std::snprintf(name, sizeof(name), "std::atomic<quantity>, %u threads", threads);
+    bench::run(name, increments, [&] {
+      atomic_counter c;
+      bench::do_not_optimize(contend(c, threads));
+    }, 3);
+  }
+}
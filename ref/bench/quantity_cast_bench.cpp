@@ -0,0 +1,95 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/velocity.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  using from = quantity<kilometer_per_hour, std::int64_t>;
+  using to = quantity<mile_per_hour, std::int64_t>;
+  using c_ratio = detail::cast_ratio<to, from::unit>;
+
+  constexpr std::size_t size = 1 << 20;
+
+  std::vector<from> make_input(std::int64_t range)
+  {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<std::int64_t> dist(-range, range);
+    std::vector<from> v(size);
+    for(auto& q : v) q = from(dist(gen));
+    return v;
+  }
+
+  // the formula used before the overflow-free path was introduced
+  std::int64_t single_multiply(const from& q) { return q.count() * c_ratio::num / c_ratio::den; }
+
+  std::int64_t split(const from& q) { return quantity_cast<to>(q).count(); }
+
+  std::int64_t long_double(const from& q)
+  {
+    return static_cast<std::int64_t>(quantity_cast<quantity<mile_per_hour, long double>>(q).count());
+  }
+
+  template<typename F>
+  void run(const char* name, const std::vector<from>& in, F f)
+  {
+    std::vector<std::int64_t> out(in.size());
+    bench::run(name, in.size(), [&] {
+      for(std::size_t i = 0; i < in.size(); ++i) out[i] = f(in[i]);
+      bench::do_not_optimize(out.data());
+    });
+  }
+
+}  // namespace
+
+int main()
+{
+  std::printf("km/h -> mph (ratio %jd/%jd), int64_t reps\n", c_ratio::num, c_ratio::den);
+
+  // small values: every path is exact
+  const auto small = make_input(std::int64_t(1) << 40);
+  run("single multiply (small values)", small, single_multiply);
+  run("overflow-free quantity_cast (small values)", small, split);
+  run("long double workaround (small values)", small, long_double);
+
+  // large values: the single multiply overflows, the other two do not
+  const auto large = make_input(std::int64_t(1) << 62);
+  run("overflow-free quantity_cast (large values)", large, split);
+  run("long double workaround (large values)", large, long_double);
+
+#if defined(__SIZEOF_INT128__)
+  std::size_t split_errors = 0, long_double_errors = 0;
+  for(const auto& q : large) {
+    const auto exact = static_cast<std::int64_t>(detail::int128(q.count()) * c_ratio::num / c_ratio::den);
+    split_errors += split(q) != exact;
+    long_double_errors += long_double(q) != exact;
+  }
+  std::printf("inexact results for large values: overflow-free %zu, long double %zu (of %zu)\n", split_errors,
+              long_double_errors, large.size());
+#endif
+}
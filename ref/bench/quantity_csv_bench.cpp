@@ -0,0 +1,112 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "bench.h"
+#include "../include/quantity_csv.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t rows = 1 << 22;
+  constexpr const char* path = "quantity_csv_bench.csv";
+
+  std::size_t make_file()
+  {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<int> number(0, 999'999);
+    std::FILE* f = std::fopen(path, "wb");
+    std::fputs("id,speed[km/h],label,t[ms],distance[km]\n", f);
+    for(std::size_t i = 0; i < rows; ++i)
+      std::fprintf(f, "%zu,%d.%03d,sensor-%d,%d,%d.%d\n", i, number(gen) / 1000, number(gen) % 1000, number(gen) % 64,
+                   number(gen), number(gen) % 1000, number(gen) % 10);
+    const auto size = static_cast<std::size_t>(std::ftell(f));
+    std::fclose(f);
+    return size;
+  }
+
+  struct columns {
+    quantity_array<meter_per_second, double> speed;
+    quantity_array<millisecond, std::int64_t> t;
+    quantity_array<metre, double> distance;
+  };
+
+  // the row by row way: std::getline, splitting of the fields and std::stod with hand-written conversion factors
+  std::size_t getline_stod(columns& c)
+  {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    c.speed.clear();
+    c.t.clear();
+    c.distance.clear();
+    std::string fields[5];
+    while(std::getline(in, line)) {
+      std::size_t pos = 0;
+      for(auto& field : fields) {
+        const std::size_t next = line.find(',', pos);
+        field = line.substr(pos, next - pos);
+        pos = next + 1;
+      }
+      c.speed.push_back(quantity<meter_per_second, double>(std::stod(fields[1]) / 3.6));
+      c.t.push_back(quantity<millisecond, std::int64_t>(std::stoll(fields[3])));
+      c.distance.push_back(quantity<metre, double>(std::stod(fields[4]) * 1000));
+    }
+    return c.speed.size();
+  }
+
+  std::size_t ingest(columns& c, unsigned threads)
+  {
+    return read_csv(path, csv_options{',', threads}, csv_column("speed", c.speed), csv_column("t", c.t),
+                    csv_column("distance", c.distance));
+  }
+
+  template<typename F>
+  void run(const char* name, std::size_t bytes, F f)
+  {
+    columns c;
+    const double ns = bench::run(name, rows, [&] { bench::do_not_optimize(f(c)); }, 5);
+    std::printf("%-48s %10.2f GB/s\n", "", static_cast<double>(bytes) / static_cast<double>(rows) / ns);
+  }
+
+}  // namespace
+
+int main()
+{
+  const std::size_t bytes = make_file();
+  const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%zu rows, 3 of 5 columns converted, %zu MB\n", rows, bytes >> 20);
+  run("std::getline + std::stod", bytes, getline_stod);
+  run("read_csv, 1 thread", bytes, [](columns& c) { return ingest(c, 1); });
+  if(hw > 1) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "read_csv, %u threads", hw);
+    run(name, bytes, [&](columns& c) { return ingest(c, hw); });
+  }
+  std::remove(path);
+}
@@ -0,0 +1,84 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "bench.h"
+#include "../include/quantity_file.h"
+#include "../include/time.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t size = 1 << 24;
+  constexpr const char* path = "quantity_file_bench.col";
+
+  using timestamp = quantity<nanosecond, std::int64_t>;
+
+  // the unit-less baseline: a raw array read back with fread
+  std::int64_t fread_sum()
+  {
+    std::vector<std::int64_t> values(size);
+    std::FILE* f = std::fopen(path, "rb");
+    std::fseek(f, sizeof(column_header), SEEK_SET);
+    const std::size_t n = std::fread(values.data(), sizeof(std::int64_t), size, f);
+    std::fclose(f);
+    std::int64_t sum = 0;
+    for(std::size_t i = 0; i < n; ++i) sum += values[i];
+    return sum;
+  }
+
+  template<typename Unit, typename Rep>
+  Rep column_sum()
+  {
+    const column_reader<Unit, Rep> reader(path);
+    Rep sum = 0;
+    reader.for_each_batch([&](quantity_span<const quantity<Unit, Rep>> batch) {
+      for(const auto& q : batch) sum += q.count();
+    });
+    return sum;
+  }
+
+  template<typename F>
+  void run(const char* name, F f)
+  {
+    const double ns = bench::run(name, size, [&] { bench::do_not_optimize(f()); });
+    std::printf("%-48s %10.1f GB/s\n", "", static_cast<double>(sizeof(std::int64_t)) / ns);
+  }
+
+}  // namespace
+
+int main()
+{
+  {
+    column_writer<nanosecond, std::int64_t> writer(path);
+    for(std::size_t i = 0; i < size; ++i) writer.append(timestamp(static_cast<std::int64_t>(i) * 1000 + 17));
+  }
+
+  std::printf("sum of %zu nanosecond timestamps, int64_t (%zu MB)\n", size, (size * sizeof(timestamp)) >> 20);
+  run("std::fread of a raw array", fread_sum);
+  run("column_reader, nanosecond, int64_t (zero-copy)", column_sum<nanosecond, std::int64_t>);
+  run("column_reader -> microsecond, int64_t", column_sum<microsecond, std::int64_t>);
+  run("column_reader -> second, double", column_sum<second, double>);
+  std::remove(path);
+}
@@ -0,0 +1,151 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/quantity_ring.h"
+#include "../include/time.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t samples = 1 << 24;
+  constexpr std::size_t capacity = 1 << 14;
+  constexpr int round_trips = 100'000;
+
+  using sample = quantity<nanosecond, std::int64_t>;
+
+  std::string segment_name(const char* what)
+  {
+    return "/units_ring_bench_" + std::to_string(::getpid()) + "_" + what;
+  }
+
+  // spins while the other process makes progress; yielding keeps single-core machines usable
+  void backoff() { ::sched_yield(); }
+
+  // runs 'child' in a forked process and returns its exit status
+  template<typename F>
+  pid_t spawn(F&& child)
+  {
+    const pid_t pid = ::fork();
+    if(pid == 0) ::_exit(child());
+    return pid;
+  }
+
+  bool join(pid_t pid)
+  {
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+
+  // the producer pushes 'samples' values in batches to a consumer process that checks their sum
+  template<ring_producers Producers>
+  void throughput(const char* title, std::size_t batch)
+  {
+    const std::string name = segment_name("throughput");
+    auto ring = shm_ring<sample, Producers>::create(name.c_str(), capacity);
+    const pid_t consumer = spawn([&] {
+      auto in = shm_ring<sample, Producers>::attach(name.c_str());
+      std::vector<sample> buf(batch);
+      std::int64_t sum = 0;
+      for(std::size_t received = 0; received < samples;) {
+        const std::size_t n = in.try_pop(quantity_span<sample>(buf.data(), buf.size()));
+        if(n == 0) backoff();
+        for(std::size_t i = 0; i < n; ++i) sum += buf[i].count();
+        received += n;
+      }
+      const auto total = static_cast<std::int64_t>(samples);
+      return sum == total * (total - 1) / 2 ? 0 : 1;
+    });
+
+    std::vector<sample> buf(batch);
+    const auto start = std::chrono::steady_clock::now();
+    for(std::size_t sent = 0; sent < samples;) {
+      const std::size_t n = std::min(batch, samples - sent);
+      for(std::size_t i = 0; i < n; ++i) buf[i] = sample(static_cast<std::int64_t>(sent + i));
+      for(std::size_t done = 0; done < n;) {
+        const std::size_t pushed = ring.try_push(quantity_span<const sample>(buf.data() + done, n - done));
+        if(pushed == 0) backoff();
+        done += pushed;
+      }
+      sent += n;
+    }
+    const bool ok = join(consumer);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    shm_ring<sample, Producers>::remove(name.c_str());
+    std::printf("%-32s batch %4zu %10.2f Msamples/s%s\n", title, batch, 1e3 * samples / elapsed.count(),
+                ok ? "" : "  (FAILED)");
+  }
+
+  // a timestamp goes to the other process and is echoed back on a second ring
+  void latency()
+  {
+    const std::string ping_name = segment_name("ping");
+    const std::string pong_name = segment_name("pong");
+    auto ping = shm_ring<sample>::create(ping_name.c_str(), 64);
+    auto pong = shm_ring<sample>::create(pong_name.c_str(), 64);
+    const pid_t echo = spawn([&] {
+      auto in = shm_ring<sample>::attach(ping_name.c_str());
+      auto out = shm_ring<sample>::attach(pong_name.c_str());
+      sample s;
+      for(int i = 0; i < round_trips; ++i) {
+        while(!in.try_pop(s)) backoff();
+        while(!out.try_push(s)) backoff();
+      }
+      return 0;
+    });
+
+    std::vector<double> rtt(round_trips);
+    for(int i = 0; i < round_trips; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      sample s(start.time_since_epoch().count());
+      while(!ping.try_push(s)) backoff();
+      while(!pong.try_pop(s)) backoff();
+      const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      rtt[static_cast<std::size_t>(i)] = elapsed.count();
+    }
+    join(echo);
+    shm_ring<sample>::remove(ping_name.c_str());
+    shm_ring<sample>::remove(pong_name.c_str());
+    std::sort(rtt.begin(), rtt.end());
+    std::printf("%-32s median %.0f ns, p99 %.0f ns\n", "round trip between processes", rtt[rtt.size() / 2],
+                rtt[rtt.size() * 99 / 100]);
+  }
+
+}  // namespace
+
+int main()
+{
+  for(std::size_t batch : {1, 16, 256}) throughput<ring_producers::single>("spsc", batch);
+  for(std::size_t batch : {1, 16, 256}) throughput<ring_producers::multiple>("mpsc (one producer)", batch);
+  latency();
+}
@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/quantity_stats.h"
+#include "../include/time.h"
+#include "../include/velocity.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t size = 1 << 24;
+
+  using latency = quantity<nanosecond, std::int64_t>;
+  using speed = quantity<meter_per_second, double>;
+
+  // what the call sites did before: Welford's update on the raw count
+  struct raw_welford {
+    std::uint64_t n = 0;
+    double mean = 0;
+    double m2 = 0;
+    void update(double x)
+    {
+      ++n;
+      const double delta = x - mean;
+      mean += delta / static_cast<double>(n);
+      m2 += delta * (x - mean);
+    }
+  };
+
+  template<typename Q>
+  void run_all(const char* title, const std::vector<Q>& values)
+  {
+    using stats = quantity_stats<typename Q::unit, typename Q::rep>;
+    const quantity_span<const Q> all(values.data(), values.size());
+    std::printf("%s\n", title);
+    bench::run("Welford loop on count()", size, [&] {
+      raw_welford w;
+      for(const Q& q : values) w.update(static_cast<double>(q.count()));
+      bench::do_not_optimize(w);
+    });
+    bench::run("quantity_stats::update(q)", size, [&] {
+      stats s;
+      for(const Q& q : values) s.update(q);
+      bench::do_not_optimize(s);
+    });
+    bench::run("quantity_stats::update(span)", size, [&] {
+      stats s;
+      s.update(all);
+      bench::do_not_optimize(s);
+    });
+    bench::run("4 threads with update(span) + merge", size, [&] {
+      stats part[4];
+      std::vector<std::thread> pool;
+      for(std::size_t t = 0; t < 4; ++t)
+        pool.emplace_back([&, t] { part[t].update(all.subspan(t * size / 4, size / 4)); });
+      for(auto& t : pool) t.join();
+      bench::do_not_optimize(part[0] + part[1] + part[2] + part[3]);
+    });
+  }
+
+}  // namespace
+
+int main()
+{
+  std::mt19937_64 gen(42);
+  std::lognormal_distribution<double> dist(11, 1);
+  std::vector<latency> latencies(size);
+  std::vector<speed> speeds(size);
+  for(auto& l : latencies) l = latency(static_cast<std::int64_t>(dist(gen)));
+  for(auto& v : speeds) v = speed(dist(gen) / 1e4);
+  run_all("int64_t nanosecond latencies", latencies);
+  run_all("double metre per second speeds", speeds);
+}
@@ -0,0 +1,85 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "bench.h"
+#include "../include/quantity_varint.h"
+#include "../include/time.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t size = 1 << 20;
+
+  using timestamp = quantity<millisecond, std::int64_t>;
+
+  // mostly increasing timestamps with jitter, like samples of a periodic process
+  std::vector<timestamp> make_input(int max_step)
+  {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<int> step(-max_step / 8, max_step);
+    std::vector<timestamp> in;
+    in.reserve(size);
+    std::int64_t t = 1'700'000'000'000;
+    for(std::size_t i = 0; i < size; ++i) in.emplace_back(t += step(gen));
+    return in;
+  }
+
+  void run_all(const char* title, const std::vector<timestamp>& in)
+  {
+    const quantity_span<const timestamp> values(in.data(), in.size());
+    std::vector<std::uint8_t> wire(max_varint_size(size));
+    std::vector<timestamp> out(size);
+    const std::size_t encoded = varint_encode(values, wire.data());
+    std::printf("%s: %.2f bytes/value (8 fixed)\n", title, static_cast<double>(encoded) / size);
+
+    auto report = [](double ns) {
+      std::printf("%-48s %10.2f GB/s of quantities\n", "", static_cast<double>(sizeof(timestamp)) / ns);
+    };
+    report(bench::run("memcpy of the fixed 8-byte encoding", size, [&] {
+      std::memcpy(out.data(), in.data(), size * sizeof(timestamp));
+      bench::do_not_optimize(out.data());
+    }));
+    report(bench::run("varint_encode", size, [&] { bench::do_not_optimize(varint_encode(values, wire.data())); }));
+    report(bench::run("varint_decode, scalar", size, [&] {
+      column_header h;
+      const std::uint8_t* p = detail::get_varint_tag(wire.data(), wire.data() + encoded, h);
+      std::uint64_t prev = 0;
+      bench::do_not_optimize(detail::decode_groups_scalar(p, wire.data() + encoded, size, prev, out.data()));
+    }));
+    report(bench::run("varint_decode", size, [&] {
+      bench::do_not_optimize(varint_decode(wire.data(), wire.data() + encoded, quantity_span<timestamp>(out.data(), size)));
+    }));
+    if(!std::equal(in.begin(), in.end(), out.begin())) std::printf("round trip FAILED\n");
+  }
+
+}  // namespace
+
+int main()
+{
+  run_all("steps up to 100 ms", make_input(100));
+  run_all("steps up to 100 s", make_input(100'000));
+}
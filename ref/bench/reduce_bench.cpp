@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/quantity_algorithm.h"
+#include "../include/length.h"
+#include "../include/time.h"
+#include "../include/velocity.h"
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t size = 1 << 24;
+
+  using length = quantity<millimetre, std::int64_t>;
+  using speed = quantity<meter_per_second, double>;
+  using step = quantity<second, double>;
+
+  template<typename T>
+  quantity_span<const T> view(const std::vector<T>& v)
+  {
+    return quantity_span<const T>(v.data(), v.size());
+  }
+
+}  // namespace
+
+int main()
+{
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<std::int64_t> mm(0, 10'000'000);
+  std::uniform_real_distribution<double> real(0, 50);
+  std::vector<length> lengths(size);
+  std::vector<speed> speeds(size);
+  std::vector<step> steps(size);
+  for(auto& l : lengths) l = length(mm(gen));
+  for(auto& v : speeds) v = speed(real(gen));
+  for(auto& t : steps) t = step(real(gen) / 1000);
+
+  const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("hardware threads: %u\n", hw);
+  char name[64];
+
+  std::printf("sum of %zu int64_t millimetres\n", size);
+  bench::run("std::accumulate", size, [&] {
+    bench::do_not_optimize(std::accumulate(lengths.begin(), lengths.end(), length::zero()));
+  });
+  bench::run("units::reduce(seq)", size, [&] { bench::do_not_optimize(reduce(view(lengths))); });
+  for(unsigned threads = 1; threads <= std::max(hw, 4u); threads *= 2) {
+    std::snprintf(name, sizeof(name), "units::reduce(par), %u threads", threads);
+    bench::run(name, size, [&] {
+      bench::do_not_optimize(reduce(execution::parallel_policy{threads}, view(lengths)));
+    });
+  }
+
+  std::printf("distance travelled: sum(velocity * dt) over %zu double samples\n", size);
+  bench::run("std::inner_product", size, [&] {
+    using distance = decltype(speeds[0] * steps[0]);
+    bench::do_not_optimize(std::inner_product(speeds.begin(), speeds.end(), steps.begin(), distance::zero()));
+  });
+  bench::run("units::transform_reduce(seq)", size, [&] {
+    bench::do_not_optimize(transform_reduce(view(speeds), view(steps)));
+  });
+  bench::run("units::transform_reduce(unseq)", size, [&] {
+    bench::do_not_optimize(transform_reduce(execution::unseq, view(speeds), view(steps)));
+  });
+  for(unsigned threads = 1; threads <= std::max(hw, 4u); threads *= 2) {
+    std::snprintf(name, sizeof(name), "units::transform_reduce(par_unseq), %u thr", threads);
+    bench::run(name, size, [&] {
+      const execution::parallel_unsequenced_policy policy{threads};
+      bench::do_not_optimize(transform_reduce(policy, view(speeds), view(steps)));
+    });
+  }
+}
@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/resampler.h"
+#include "../include/velocity.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t size = 60'000;  // one minute at 1 kHz; cache-resident like a freshly received buffer
+
+  using timestamp = quantity<millisecond, std::int64_t>;
+  using speed = quantity<meter_per_second, double>;
+
+  // what the call sites did before: a floating-point window index per sample on the raw counts
+  struct raw_window {
+    std::int64_t index = -1;
+    std::size_t count = 0;
+    double sum = 0, min = 0, max = 0, last = 0;
+  };
+
+}  // namespace
+
+int main()
+{
+  std::mt19937_64 gen(42);
+  std::normal_distribution<double> dist(20, 3);
+  std::vector<timestamp> times(size);
+  std::vector<speed> speeds(size);
+  for(std::size_t i = 0; i < size; ++i) {
+    times[i] = timestamp(static_cast<std::int64_t>(i));
+    speeds[i] = speed(dist(gen));
+  }
+  const quantity_span<const timestamp> t(times.data(), size);
+  const quantity_span<const speed> v(speeds.data(), size);
+
+  std::size_t windows = 0;
+  bench::run("per-sample floor(t / 1000.0) on count()", size, [&] {
+    raw_window w;
+    windows = 0;
+    for(std::size_t i = 0; i < size; ++i) {
+      const auto index = static_cast<std::int64_t>(static_cast<double>(times[i].count()) / 1000.0);
+      const double x = speeds[i].count();
+      if(index != w.index) {
+        if(w.count != 0) ++windows;
+        w = raw_window{index, 1, x, x, x, x};
+      }
+      else {
+        ++w.count;
+        w.sum += x;
+        w.min = std::min(w.min, x);
+        w.max = std::max(w.max, x);
+        w.last = x;
+      }
+    }
+    bench::do_not_optimize(w);
+  });
+  std::printf("%zu windows\n", windows + 1);
+
+  auto count_windows = [&](const auto& w) {
+    ++windows;
+    bench::do_not_optimize(w.mean);
+    bench::do_not_optimize(w.max);
+  };
+  bench::run("resampler, one sample at a time", size, [&] {
+    resampler<speed> r(quantity<hertz>(1));
+    windows = 0;
+    for(std::size_t i = 0; i < size; ++i) r.push(times[i], speeds[i], count_windows);
+    r.flush(count_windows);
+  });
+  bench::run("resampler, batches of 4096", size, [&] {
+    resampler<speed> r(quantity<hertz>(1));
+    windows = 0;
+    for(std::size_t i = 0; i < size; i += 4096) {
+      const std::size_t n = std::min<std::size_t>(4096, size - i);
+      r.push(t.subspan(i, n), v.subspan(i, n), count_windows);
+    }
+    r.flush(count_windows);
+  });
+  std::printf("%zu windows\n", windows);
+  bench::run("resampler, 3 Hz (exact 333/334 ms windows)", size, [&] {
+    resampler<speed> r(quantity<hertz>(3));
+    windows = 0;
+    r.push(t, v, count_windows);
+    r.flush(count_windows);
+  });
+  std::printf("%zu windows\n", windows);
+}
@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/sample_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t samples = 1 << 22;
+  constexpr int round_trips = 100'000;
+
+  using timestamp = quantity<nanosecond, std::int64_t>;
+
+  timestamp now()
+  {
+    return timestamp(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+}  // namespace
+
+int main()
+{
+  sample_queue<double> queue(1024);
+  bench::run("push + pop on one thread", samples, [&] {
+    timed_sample<double> s{};
+    for(std::size_t i = 0; i < samples; ++i) {
+      queue.try_push(timestamp(static_cast<std::int64_t>(i)), 1.0);
+      queue.try_pop(s);
+    }
+    bench::do_not_optimize(s);
+  });
+  bench::run("rate()", 1000, [&] {
+    for(std::int64_t i = 0; i < 1000; ++i) bench::do_not_optimize(queue.rate(timestamp(samples + i)));
+  });
+
+  bench::run("producer and consumer threads, batches of 64", samples, [&] {
+    std::thread consumer([&] {
+      timed_sample<double> buf[64];
+      for(std::size_t received = 0; received < samples;) {
+        const std::size_t n = queue.try_pop(buf, 64);
+        if(n == 0) std::this_thread::yield();
+        received += n;
+      }
+    });
+    for(std::size_t i = 0; i < samples; ++i)
+      while(!queue.try_push(timestamp(static_cast<std::int64_t>(i)), 1.0)) std::this_thread::yield();
+    consumer.join();
+  }, 3);
+
+  // round trip: a second thread echoes every sample back on another queue
+  sample_queue<double> ping(64);
+  sample_queue<double> pong(64);
+  std::thread echo([&] {
+    timed_sample<double> s{};
+    for(int i = 0; i < round_trips; ++i) {
+      while(!ping.try_pop(s)) std::this_thread::yield();
+      while(!pong.try_push(s)) std::this_thread::yield();
+    }
+  });
+  std::vector<double> rtt(round_trips);
+  for(auto& r : rtt) {
+    const timestamp start = now();
+    timed_sample<double> s{start, 0};
+    while(!ping.try_push(s)) std::this_thread::yield();
+    while(!pong.try_pop(s)) std::this_thread::yield();
+    r = static_cast<double>((now() - start).count());
+  }
+  echo.join();
+  std::sort(rtt.begin(), rtt.end());
+  std::printf("%-48s median %.0f ns, p99 %.0f ns\n", "round trip between threads", rtt[rtt.size() / 2],
+              rtt[rtt.size() * 99 / 100]);
+  std::printf("%-48s %.0f Hz\n", "rate of the ping queue over the last second", ping.rate(now()).count());
+}
@@ -0,0 +1,80 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/sharded_quantity.h"
+#include "../include/time.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t increments_per_thread = 1 << 21;
+
+  using busy_time = quantity<second, std::int64_t>;
+  using request_time = quantity<hour, std::int64_t>;
+
+  // every thread adds 'increments_per_thread' seconds; returns aggregate increments per second
+  template<typename Add>
+  double scale(unsigned threads, Add add)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(unsigned t = 0; t < threads; ++t)
+      pool.emplace_back([&add] {
+        for(std::size_t i = 0; i < increments_per_thread; ++i) add(busy_time(1));
+      });
+    for(auto& t : pool) t.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(increments_per_thread) * threads / elapsed.count();
+  }
+
+}  // namespace
+
+int main()
+{
+  std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  for(unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+    std::atomic<busy_time> single{busy_time::zero()};
+    const double a = scale(threads, [&](busy_time s) { single.fetch_add(s, std::memory_order_relaxed); });
+    sharded_quantity<second, std::int64_t> sharded;
+    const double b = scale(threads, [&](busy_time s) { sharded += s; });
+    const bool ok = single.load().count() == sharded.load().count();
+    std::printf("%2u threads: std::atomic %8.1f M/s, sharded_quantity %8.1f M/s%s\n", threads, a / 1e6, b / 1e6,
+                ok ? "" : "  (MISMATCH)");
+  }
+
+  char name[64];
+  for(std::size_t shards : {1, 8, 64, 256}) {
+    sharded_quantity<second, std::int64_t> q(shards);
+    q += busy_time(7200);
+    std::snprintf(name, sizeof(name), "load<hour>() over %zu shards", shards);
+    bench::run(name, 1000, [&] {
+      for(int i = 0; i < 1000; ++i) bench::do_not_optimize(q.load<request_time>());
+    });
+  }
+}
@@ -0,0 +1,102 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "bench.h"
+#include "../include/quantity_charconv.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t size = 1 << 20;
+
+  template<typename Q>
+  std::vector<Q> make_input()
+  {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<int> number(0, 999'999'999);
+    std::vector<Q> in;
+    in.reserve(size);
+    for(std::size_t i = 0; i < size; ++i) in.emplace_back(static_cast<typename Q::rep>(number(gen)) / 1000);
+    return in;
+  }
+
+  // the iostream way: a stream per value with the symbol spelled out by hand
+  template<typename Q>
+  std::size_t ostringstream_format(const Q& q, char*)
+  {
+    std::ostringstream os;
+    os << q.count() << ' ' << unit_symbol<typename Q::unit>;
+    return os.str().size();
+  }
+
+  // a reused stream, the best case of the iostream way
+  template<typename Q>
+  std::size_t reused_ostringstream_format(const Q& q, char*)
+  {
+    static std::ostringstream os;
+    os.str(std::string());
+    os << q.count() << ' ' << unit_symbol<typename Q::unit>;
+    return static_cast<std::size_t>(os.tellp());
+  }
+
+  template<typename Q>
+  std::size_t to_chars_format(const Q& q, char* buffer)
+  {
+    return static_cast<std::size_t>(to_chars(buffer, buffer + 64, q).ptr - buffer);
+  }
+
+  template<typename Q, typename F>
+  void run(const char* name, const std::vector<Q>& in, F f)
+  {
+    char buffer[64];
+    std::size_t chars = 0;
+    const double ns = bench::run(name, in.size(), [&] {
+      for(const Q& q : in) chars += f(q, buffer);
+      bench::do_not_optimize(buffer);
+      bench::do_not_optimize(chars);
+    });
+    std::printf("%-48s %10.1f M values/s\n", "", 1e3 / ns);
+  }
+
+  template<typename Q>
+  void run_all(const char* title)
+  {
+    const auto in = make_input<Q>();
+    std::printf("%s\n", title);
+    run("std::ostringstream", in, ostringstream_format<Q>);
+    run("std::ostringstream, reused", in, reused_ostringstream_format<Q>);
+    run("to_chars", in, to_chars_format<Q>);
+  }
+
+}  // namespace
+
+int main()
+{
+  run_all<quantity<kilometer_per_hour, double>>("\"123456.789 km/h\"-like values, double");
+  run_all<quantity<millimetre, std::int64_t>>("\"123456 mm\"-like values, int64_t");
+}
@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+#include "../include/tsc_clock.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+  using namespace units;
+
+  constexpr std::size_t calls = 1 << 20;
+
+}  // namespace
+
+int main()
+{
+  std::printf("counter: %s, %.6f GHz\n", tsc_clock::is_hardware ? "hardware" : "steady_clock fallback",
+              tsc_clock::frequency().count());
+
+  bench::run("std::chrono::steady_clock::now()", calls, [] {
+    for(std::size_t i = 0; i < calls; ++i) bench::do_not_optimize(std::chrono::steady_clock::now());
+  });
+  bench::run("tsc_clock::ticks()", calls, [] {
+    for(std::size_t i = 0; i < calls; ++i) bench::do_not_optimize(tsc_clock::ticks());
+  });
+  bench::run("tsc_clock::now()", calls, [] {
+    for(std::size_t i = 0; i < calls; ++i) bench::do_not_optimize(tsc_clock::now());
+  });
+  bench::run("scoped_trace (two reads + record)", calls, [] {
+    for(std::size_t i = 0; i < calls; ++i) {
+      scoped_trace trace("bench");
+      bench::do_not_optimize(i);
+    }
+  });
+
+  // drift from steady_clock accumulated since the calibration (one to two seconds ago)
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  const auto steady = std::chrono::steady_clock::now().time_since_epoch();
+  const auto tsc = tsc_clock::now();
+  std::printf("tsc_clock::now() - steady_clock::now(): %lld ns\n",
+              static_cast<long long>(tsc.count() - std::chrono::nanoseconds(steady).count()));
+
+  std::uint64_t total = 0;
+  trace_buffer<>::local().for_each(
+      [&](const trace_event& e) { total += static_cast<std::uint64_t>(e.duration.count()); });
+  std::printf("%zu traced events kept, %llu dropped, mean %.1f ns\n", trace_buffer<>::local().size(),
+              static_cast<unsigned long long>(trace_buffer<>::local().dropped()),
+              static_cast<double>(total) / static_cast<double>(trace_buffer<>::local().size()));
+}
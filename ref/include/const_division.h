@@ -0,0 +1,192 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace units::detail {
+
+  // compile-time strength reduction of a signed 64-bit division by a constant (truncates toward zero like '/')
+
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef __int128 int128;
+  __extension__ typedef unsigned __int128 uint128;
+#endif
+
+  template<typename T>
+  inline constexpr bool is_int64 = std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 8;
+
+  // divisor_kind
+
+  enum class divisor_kind { one, power_of_two, magic, generic };
+
+  template<std::intmax_t D>
+  inline constexpr bool is_power_of_two = D > 0 && (D & (D - 1)) == 0;
+
+  template<std::intmax_t D>
+  constexpr int log2()
+  {
+    int k = 0;
+    while((std::intmax_t(1) << k) < D) ++k;
+    return k;
+  }
+
+  // magic_divisor
+
+  // Granlund & Montgomery; "Hacker's Delight" 10-1 for 2 <= D < 2^63
+  template<std::intmax_t D>
+  struct magic_divisor {
+    static_assert(D >= 2);
+
+    struct result {
+      std::uint64_t multiplier;
+      int shift;
+    };
+
+    static constexpr result compute()
+    {
+      constexpr std::uint64_t two63 = std::uint64_t(1) << 63;
+      const std::uint64_t ad = D;
+      const std::uint64_t anc = two63 - 1 - two63 % ad;
+      int p = 63;
+      std::uint64_t q1 = two63 / anc;
+      std::uint64_t r1 = two63 - q1 * anc;
+      std::uint64_t q2 = two63 / ad;
+      std::uint64_t r2 = two63 - q2 * ad;
+      std::uint64_t delta = 0;
+      do {
+        ++p;
+        q1 *= 2;
+        r1 *= 2;
+        if(r1 >= anc) {
+          ++q1;
+          r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if(r2 >= ad) {
+          ++q2;
+          r2 -= ad;
+        }
+        delta = ad - r2;
+      } while(q1 < delta || (q1 == delta && r1 == 0));
+      return {q2 + 1, p - 64};
+    }
+
+    static constexpr std::uint64_t multiplier = compute().multiplier;
+    static constexpr int shift = compute().shift;
+  };
+
+  template<typename T, std::intmax_t D>
+  constexpr divisor_kind select_divisor()
+  {
+    if constexpr(D == 1)
+      return divisor_kind::one;
+    else if constexpr(!is_int64<T>)
+      return divisor_kind::generic;
+    else if constexpr(is_power_of_two<D>)
+      return divisor_kind::power_of_two;
+#if defined(__SIZEOF_INT128__)
+    else
+      return divisor_kind::magic;
+#else
+    else
+      return divisor_kind::generic;
+#endif
+  }
+
+  // divide
+
+  template<std::intmax_t D, typename T>
+  [[nodiscard]] constexpr T divide(T n)
+  {
+    static_assert(D > 0, "ratio denominators are always positive");
+    constexpr divisor_kind kind = select_divisor<T, D>();
+    if constexpr(kind == divisor_kind::one)
+      return n;
+    else if constexpr(kind == divisor_kind::power_of_two) {
+      // bias negative values so that the arithmetic shift truncates toward zero
+      constexpr int k = log2<D>();
+      const T bias = (n >> 63) & T(D - 1);
+      return (n + bias) >> k;
+    }
+#if defined(__SIZEOF_INT128__)
+    else if constexpr(kind == divisor_kind::magic) {
+      using magic = magic_divisor<D>;
+      const auto m = static_cast<std::int64_t>(magic::multiplier);
+      auto q = static_cast<std::int64_t>((int128(m) * int128(n)) >> 64);
+      if constexpr(static_cast<std::int64_t>(magic::multiplier) < 0) q += n;
+      q >>= magic::shift;
+      return static_cast<T>(q + static_cast<std::int64_t>(static_cast<std::uint64_t>(n) >> 63));
+    }
+#endif
+    else
+      return n / static_cast<T>(D);
+  }
+
+  // multiply_divide
+
+  // 'n * Num / Den' evaluated without overflowing the intermediate product whenever the result itself fits in T;
+  // with n = q * Den + r (q and r carry the sign of n) the result is q * Num + r * Num / Den
+  template<std::intmax_t Num, std::intmax_t Den, typename T>
+  [[nodiscard]] constexpr T multiply_divide(T n)
+  {
+    static_assert(std::is_integral_v<T>);
+    if constexpr(Num <= std::numeric_limits<T>::max() / Den) {
+      const T q = divide<Den>(n);
+      const T r = n - q * static_cast<T>(Den);
+      return q * static_cast<T>(Num) + divide<Den>(r * static_cast<T>(Num));
+    }
+#if defined(__SIZEOF_INT128__)
+    else if constexpr(std::is_signed_v<T>)
+      return static_cast<T>(int128(n) * Num / Den);
+    else
+      return static_cast<T>(uint128(n) * static_cast<std::uintmax_t>(Num) / static_cast<std::uintmax_t>(Den));
+#else
+    else
+      return n * static_cast<T>(Num) / static_cast<T>(Den);
+#endif
+  }
+
+  // may_overflow_multiply
+
+  // true unless every value of Rep multiplied by Num provably fits in CRep
+  template<typename CRep, typename Rep, std::intmax_t Num>
+  constexpr bool may_overflow_multiply()
+  {
+    if constexpr(!std::is_integral_v<CRep>)
+      return false;
+    else if constexpr(std::numeric_limits<Rep>::is_specialized && std::numeric_limits<Rep>::is_integer) {
+      constexpr auto max = static_cast<std::uintmax_t>(std::numeric_limits<Rep>::max());
+      constexpr auto min = std::numeric_limits<Rep>::min();
+      // |min| of a two's complement type is max + 1
+      constexpr std::uintmax_t magnitude = min < 0 ? max + 1 : max;
+      return static_cast<std::uintmax_t>(Num) > static_cast<std::uintmax_t>(std::numeric_limits<CRep>::max()) / magnitude;
+    }
+    else
+      return true;
+  }
+
+}  // namespace units::detail
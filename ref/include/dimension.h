@@ -82,34 +82,68 @@ namespace units {
   // make_dimension
   namespace detail {
 
-    template<typename D>
-    struct dim_consolidate;
-
-    template<>
-    struct dim_consolidate<dimension<>> {
-      using type = dimension<>;
+    // Exponents of a dimension are consolidated as a constexpr value rather than through type list algorithms:
+    // sorted by the id of the base dimension, exponents of the same base dimension summed up and the ones that
+    // cancelled out removed. `source` refers to an exponent providing the base dimension type.
+    template<std::size_t N>
+    struct dim_layout {
+      std::size_t count = 0;
+      std::size_t source[N] = {};
+      int value[N] = {};
     };
 
-    template<typename E>
-    struct dim_consolidate<dimension<E>> {
-      using type = dimension<E>;
-    };
+    template<typename... Es>
+    constexpr dim_layout<sizeof...(Es) + 1> consolidate_exponents()
+    {
+      constexpr std::size_t size = sizeof...(Es);
+      constexpr int ids[] = {Es::dimension::value..., 0};
+      constexpr int values[] = {Es::value..., 0};
+
+      dim_layout<size + 1> layout;
+      for(std::size_t i = 0; i < size; ++i) {
+        bool consolidated = false;
+        for(std::size_t j = 0; j < i; ++j)
+          consolidated = consolidated || ids[j] == ids[i];
+        if(consolidated) continue;
+
+        int sum = 0;
+        for(std::size_t j = i; j < size; ++j)
+          if(ids[j] == ids[i]) sum += values[j];
+        if(sum == 0) continue;
+
+        std::size_t pos = layout.count++;
+        for(; pos > 0 && ids[layout.source[pos - 1]] > ids[i]; --pos) {
+          layout.source[pos] = layout.source[pos - 1];
+          layout.value[pos] = layout.value[pos - 1];
+        }
+        layout.source[pos] = i;
+        layout.value[pos] = sum;
+      }
+      return layout;
+    }
 
-    template<typename E1, typename... ERest>
-    struct dim_consolidate<dimension<E1, ERest...>> {
-      using type = type_list_push_front<typename dim_consolidate<dimension<ERest...>>::type, E1>;
+    template<typename... Es>
+    struct dim_consolidate {
+      static constexpr auto layout = consolidate_exponents<Es...>();
+      using exponents = indexed_types<std::index_sequence_for<Es...>, Es...>;
+
+      template<std::size_t I>
+      using base_dimension = typename decltype(type_at<layout.source[I]>(std::declval<exponents>()))::type::dimension;
     };
 
-    template<typename D, int V1, int V2, typename... ERest>
-    struct dim_consolidate<dimension<exp<D, V1>, exp<D, V2>, ERest...>> {
-      using type = std::conditional_t<V1 + V2 == 0, typename dim_consolidate<dimension<ERest...>>::type,
-                                      typename dim_consolidate<dimension<exp<D, V1 + V2>, ERest...>>::type>;
+    template<typename Consolidated, typename Indices = std::make_index_sequence<Consolidated::layout.count>>
+    struct make_dimension_impl;
+
+    template<typename Consolidated, std::size_t... Is>
+    struct make_dimension_impl<Consolidated, std::index_sequence<Is...>> {
+      using type =
+          dimension<exp<typename Consolidated::template base_dimension<Is>, Consolidated::layout.value[Is]>...>;
     };
 
   }
 
   template<typename... Es>
-  using make_dimension = typename detail::dim_consolidate<type_list_sort<dimension<Es...>, exp_less>>::type;
+  using make_dimension = typename detail::make_dimension_impl<detail::dim_consolidate<Es...>>::type;
 
   // dim_invert
   namespace detail {
@@ -128,8 +162,20 @@ namespace units {
   using dim_invert = typename detail::dim_invert_impl<D>::type;
 
   // merge_dimension
+  namespace detail {
+
+    template<typename D>
+    struct merge_dimension_impl;
+
+    template<typename... Es>
+    struct merge_dimension_impl<dimension<Es...>> {
+      using type = make_dimension<Es...>;
+    };
+
+  }
+
   template<typename D1, typename D2>
-  using merge_dimension = typename detail::dim_consolidate<type_list_merge_sorted<D1, D2, exp_less>>::type;
+  using merge_dimension = typename detail::merge_dimension_impl<type_list_merge_sorted<D1, D2, exp_less>>::type;
 
   // dimension_multiply
   namespace detail {
@@ -139,7 +185,7 @@ namespace units {
 
     template<typename... E1, typename... E2>
     struct dimension_multiply_impl<dimension<E1...>, dimension<E2...>> {
-      using type = merge_dimension<dimension<E1...>, dimension<E2...>>;
+      using type = make_dimension<E1..., E2...>;
     };
 
   }
@@ -154,8 +200,8 @@ namespace units {
     struct dimension_divide_impl;
 
     template<typename... E1, typename... E2>
-    struct dimension_divide_impl<dimension<E1...>, dimension<E2...>>
-        : dimension_multiply_impl<dimension<E1...>, dimension<exp_invert<E2>...>> {
+    struct dimension_divide_impl<dimension<E1...>, dimension<E2...>> {
+      using type = make_dimension<E1..., exp_invert<E2>...>;
     };
 
   }
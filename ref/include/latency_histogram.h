@@ -0,0 +1,170 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "time.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace units {
+
+  namespace detail {
+
+    // the index of the highest set bit of a non-zero value
+    constexpr int highest_bit(std::uint64_t v) noexcept
+    {
+#if defined(__GNUC__)
+      return 63 - __builtin_clzll(v);
+#else
+      int n = 0;
+      for(int shift = 32; shift > 0; shift /= 2)
+        if((v >> shift) != 0) {
+          v >>= shift;
+          n += shift;
+        }
+      return n;
+#endif
+    }
+
+  }  // namespace detail
+
+  // latency_histogram
+
+  // A log-linear (HDR-style) histogram of non-negative durations stored as int64_t counts of 'Unit'. Values below
+  // 2^(Precision + 1) get a bucket each; above that every power of 2 is split into 2^Precision buckets, so a bucket is
+  // never wider than 2^-Precision of the values it holds and the whole int64_t range is covered by
+  // (64 - Precision) * 2^Precision counters (58 KiB for the default of 7 bits, i.e. 0.8% resolution). Negative
+  // values are recorded as 0.
+  //
+  // record() computes the bucket without branches and is meant for the thread owning the histogram; merge() adds
+  // another histogram with relaxed atomic additions, so any number of threads can merge their own histograms into a
+  // shared one without a lock while it is being read.
+  template<typename Unit = nanosecond, int Precision = 7>
+  class latency_histogram {
+    static_assert(std::is_same_v<typename Unit::dimension, dimension_time>, "latency_histogram records durations");
+    static_assert(Precision >= 1 && Precision <= 16, "Precision is the number of significant bits kept");
+
+  public:
+    using value_type = quantity<Unit, std::int64_t>;
+
+    static constexpr std::size_t bucket_count = std::size_t(64 - Precision) << Precision;
+
+    [[nodiscard]] static constexpr std::size_t bucket_index(const value_type& q) noexcept
+    {
+      const std::int64_t c = q.count();
+      const auto v = static_cast<std::uint64_t>(c & ~(c >> 63));  // negative values clamp to 0
+      const int msb = detail::highest_bit(v | ((std::uint64_t(1) << (Precision + 1)) - 1));
+      const int shift = msb - Precision;
+      return (std::size_t(shift) << Precision) + static_cast<std::size_t>(v >> shift);
+    }
+
+    // the smallest value in bucket 'index'
+    [[nodiscard]] static constexpr value_type bucket_lower(std::size_t index) noexcept
+    {
+      const std::size_t octave = index >> Precision;
+      const std::size_t shift = (octave == 0 ? 1 : octave) - 1;
+      return value_type(static_cast<std::int64_t>((index - (shift << Precision)) << shift));
+    }
+
+    // the largest value in bucket 'index'
+    [[nodiscard]] static constexpr value_type bucket_upper(std::size_t index) noexcept
+    {
+      const std::size_t octave = index >> Precision;
+      const std::size_t shift = (octave == 0 ? 1 : octave) - 1;
+      return value_type(bucket_lower(index).count() + ((std::int64_t(1) << shift) - 1));
+    }
+
+  private:
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counts_;
+
+  public:
+    latency_histogram() : counts_(std::make_unique<std::atomic<std::uint64_t>[]>(bucket_count)) {}
+
+    void record(const value_type& q) noexcept
+    {
+      std::atomic<std::uint64_t>& c = counts_[bucket_index(q)];
+      c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void record(const value_type& q, std::uint64_t count) noexcept
+    {
+      std::atomic<std::uint64_t>& c = counts_[bucket_index(q)];
+      c.store(c.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    // thread-safe merge of another histogram (which must not be recorded into at the same time)
+    void merge(const latency_histogram& other) noexcept
+    {
+      for(std::size_t i = 0; i < bucket_count; ++i)
+        if(const std::uint64_t n = other.counts_[i].load(std::memory_order_relaxed); n != 0)
+          counts_[i].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void reset() noexcept
+    {
+      for(std::size_t i = 0; i < bucket_count; ++i) counts_[i].store(0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t count() const noexcept
+    {
+      std::uint64_t total = 0;
+      for(std::size_t i = 0; i < bucket_count; ++i) total += counts_[i].load(std::memory_order_relaxed);
+      return total;
+    }
+
+    [[nodiscard]] std::uint64_t bucket(std::size_t index) const noexcept
+    {
+      return counts_[index].load(std::memory_order_relaxed);
+    }
+
+    // The smallest recorded value that at least 'percent' % of the samples do not exceed, up to the resolution of
+    // its bucket (the bucket's largest value is returned, rounded up to a coarser 'To', so it is never below the exact
+    // answer); zero when empty. 'percent' is clamped to [0, 100], NaN is treated as 0.
+    template<typename To = value_type>
+    [[nodiscard]] To percentile(double percent) const noexcept
+    {
+      static_assert(is_quantity<To> && same_dim<typename To::unit, Unit>, "percentiles are durations");
+      const std::uint64_t total = count();
+      if(total == 0) return To::zero();
+      if(!(percent > 0)) percent = 0;
+      if(percent > 100) percent = 100;
+      const double wanted = percent / 100 * static_cast<double>(total);
+      std::uint64_t rank = static_cast<std::uint64_t>(wanted);
+      if(static_cast<double>(rank) < wanted || rank == 0) ++rank;
+      if(rank > total) rank = total;
+      std::uint64_t seen = 0;
+      std::size_t i = 0;
+      for(; i + 1 < bucket_count; ++i)
+        if((seen += counts_[i].load(std::memory_order_relaxed)) >= rank) break;
+      const value_type upper = bucket_upper(i);
+      To result = quantity_cast<To>(upper);
+      if constexpr(!treat_as_floating_point<typename To::rep>)
+        if(result < upper) result += To(1);
+      return result;
+    }
+  };
+
+}  // namespace units
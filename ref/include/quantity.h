@@ -23,6 +23,7 @@
 #pragma once
 
 #include "common_ratio.h"
+#include "const_division.h"
 #include "unit.h"
 #include <limits>
 #include <type_traits>
@@ -59,6 +60,17 @@ namespace units {
   template<typename Rep, class Ratio>
   inline constexpr bool is_quantity<quantity<Rep, Ratio>> = true;
 
+  // is_quantity_expr (specialized by the lazy expression templates so they are never treated as a scalar)
+
+  template<typename T>
+  inline constexpr bool is_quantity_expr = false;
+
+  // quantity_conversion (specialized for types that map onto a quantity, e.g. std::chrono::duration in
+  // quantity_chrono.h; a specialization provides 'quantity_type', to_quantity() and from_quantity())
+
+  template<typename T>
+  struct quantity_conversion {};
+
   // quantity_cast
 
   namespace detail {
@@ -68,8 +80,11 @@ namespace units {
       template<typename Unit, typename Rep>
       static constexpr To cast(const quantity<Unit, Rep>& q)
       {
-        return To(static_cast<typename To::rep>(static_cast<CRep>(q.count()) * static_cast<CRep>(CRatio::num) /
-                                                static_cast<CRep>(CRatio::den)));
+        if constexpr(may_overflow_multiply<CRep, Rep, CRatio::num>())
+          return To(static_cast<typename To::rep>(multiply_divide<CRatio::num, CRatio::den>(static_cast<CRep>(q.count()))));
+        else
+          return To(static_cast<typename To::rep>(
+              divide<CRatio::den>(static_cast<CRep>(q.count()) * static_cast<CRep>(CRatio::num))));
       }
     };
 
@@ -87,7 +102,7 @@ namespace units {
       template<typename Unit, typename Rep>
       static constexpr To cast(const quantity<Unit, Rep>& q)
       {
-        return To(static_cast<typename To::rep>(static_cast<CRep>(q.count()) / static_cast<CRep>(CRatio::den)));
+        return To(static_cast<typename To::rep>(divide<CRatio::den>(static_cast<CRep>(q.count()))));
       }
     };
 
@@ -100,14 +115,20 @@ namespace units {
       }
     };
 
+    template<typename To, typename Unit>
+    using cast_ratio = std::ratio_divide<typename Unit::ratio, typename To::unit::ratio>;
+
+    template<typename To, typename Rep>
+    using cast_rep = std::common_type_t<typename To::rep, Rep, intmax_t>;
+
   }  // namespace detail
 
   template<typename To, typename Unit, typename Rep,
            Requires<is_quantity<To>> = true>
   [[nodiscard]] constexpr To quantity_cast(const quantity<Unit, Rep>& q)
   {
-    using c_ratio = std::ratio_divide<typename Unit::ratio, typename To::unit::ratio>;
-    using c_rep = std::common_type_t<typename To::rep, Rep, intmax_t>;
+    using c_ratio = detail::cast_ratio<To, Unit>;
+    using c_rep = detail::cast_rep<To, Rep>;
     using cast = detail::quantity_cast_impl<To, c_ratio, c_rep, c_ratio::num == 1, c_ratio::den == 1>;
     return cast::cast(q);
   }
@@ -157,6 +178,25 @@ namespace units {
                        (std::ratio_divide<typename Unit2::ratio, typename unit::ratio>::den == 1 && !treat_as_floating_point<Rep2>))> = true>
     constexpr quantity(const quantity<Unit2, Rep2>& q) : value_(quantity_cast<quantity>(q).count()) {}
 
+    // conversions from and to types with a quantity_conversion follow the rules above for their 'quantity_type':
+    // implicit when no precision is lost, explicit otherwise
+    template<typename T, typename Q = typename quantity_conversion<T>::quantity_type,
+             Requires<std::is_convertible_v<Q, quantity>> = true>
+    constexpr quantity(const T& v) : quantity(quantity_conversion<T>::to_quantity(v)) {}
+
+    template<typename T, typename Q = typename quantity_conversion<T>::quantity_type,
+             Requires<!std::is_convertible_v<Q, quantity> && same_dim<unit, typename Q::unit>> = true>
+    constexpr explicit quantity(const T& v) :
+        value_(quantity_cast<quantity>(quantity_conversion<T>::to_quantity(v)).count()) {}
+
+    template<typename T, typename Q = typename quantity_conversion<T>::quantity_type,
+             Requires<std::is_convertible_v<quantity, Q>> = true>
+    constexpr operator T() const { return quantity_conversion<T>::from_quantity(Q(*this)); }
+
+    template<typename T, typename Q = typename quantity_conversion<T>::quantity_type,
+             Requires<!std::is_convertible_v<quantity, Q> && same_dim<unit, typename Q::unit>> = true>
+    constexpr explicit operator T() const { return quantity_conversion<T>::from_quantity(quantity_cast<Q>(*this)); }
+
     constexpr quantity& operator=(const quantity& other) = default;
 
     [[nodiscard]] constexpr Rep count() const noexcept { return value_; }
@@ -238,7 +278,7 @@ namespace units {
     }
 
     template<typename Rep2,
-             Requires<!is_quantity<Rep2>> = true>
+             Requires<!is_quantity<Rep2> && !is_quantity_expr<Rep2>> = true>
     [[nodiscard]] friend constexpr auto operator*(const quantity& q, const Rep2& v)
         -> quantity<Unit, decltype(std::declval<Rep>() * std::declval<Rep2>())>
     {
@@ -247,7 +287,7 @@ namespace units {
     }
 
     template<typename Rep2,
-             Requires<!is_quantity<Rep2>> = true>
+             Requires<!is_quantity<Rep2> && !is_quantity_expr<Rep2>> = true>
     [[nodiscard]] friend constexpr auto operator*(const Rep2& v, const quantity& q) -> decltype(q * v)
     {
       return q * v;
@@ -276,7 +316,7 @@ namespace units {
     }
 
     template<typename Rep2,
-             Requires<!is_quantity<Rep2>> = true>
+             Requires<!is_quantity<Rep2> && !is_quantity_expr<Rep2>> = true>
     [[nodiscard]] friend constexpr auto operator/(const quantity& q, const Rep2& v)
         -> quantity<Unit, decltype(std::declval<Rep>() / std::declval<Rep2>())>
     {
@@ -285,7 +325,7 @@ namespace units {
     }
 
     template<typename Rep2,
-             Requires<!is_quantity<Rep2>> = true>
+             Requires<!is_quantity<Rep2> && !is_quantity_expr<Rep2>> = true>
     [[nodiscard]] friend constexpr auto operator/(const Rep2& v, const quantity& q)
         -> quantity<units::unit<dim_invert<typename unit::dimension>, typename unit::ratio>, decltype(std::declval<Rep2>() / std::declval<Rep>())>
     {
@@ -315,7 +355,7 @@ namespace units {
     }
 
     template<typename Rep2, typename T = Rep,
-             Requires<!is_quantity<Rep2> &&
+             Requires<!is_quantity<Rep2> && !is_quantity_expr<Rep2> &&
                       !treat_as_floating_point<T> &&
                       !treat_as_floating_point<Rep2>> = true>
     [[nodiscard]] friend constexpr quantity operator%(const quantity& q, const Rep2& v)
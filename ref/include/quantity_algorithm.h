@@ -0,0 +1,315 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "const_division.h"
+#include "quantity_array.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ratio>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace units {
+
+  // execution policies
+
+  // Mirrors of the standard policies, so the algorithms below do not pull in <execution> (and with it a parallel
+  // backend that has to be linked). The parallel ones may name a number of threads; 0 means one per hardware thread.
+  namespace execution {
+
+    struct sequenced_policy {};
+    struct unsequenced_policy {};
+    struct parallel_policy {
+      unsigned threads = 0;
+    };
+    struct parallel_unsequenced_policy {
+      unsigned threads = 0;
+    };
+
+    inline constexpr sequenced_policy seq{};
+    inline constexpr unsequenced_policy unseq{};
+    inline constexpr parallel_policy par{};
+    inline constexpr parallel_unsequenced_policy par_unseq{};
+
+    template<typename T>
+    inline constexpr bool is_execution_policy =
+        std::is_same_v<T, sequenced_policy> || std::is_same_v<T, unsequenced_policy> ||
+        std::is_same_v<T, parallel_policy> || std::is_same_v<T, parallel_unsequenced_policy>;
+
+  }  // namespace execution
+
+  // accumulator_rep
+
+  namespace detail {
+
+    template<typename Rep, bool Integral = std::is_integral_v<Rep>, bool Floating = std::is_floating_point_v<Rep>>
+    struct accumulator_rep_impl {
+      using type = Rep;
+    };
+
+    template<typename Rep>
+    struct accumulator_rep_impl<Rep, true, false> {
+      using type = std::conditional_t<std::is_signed_v<Rep>,
+                                      std::conditional_t<(sizeof(Rep) < 8), std::int64_t, int128>,
+                                      std::conditional_t<(sizeof(Rep) < 8), std::uint64_t, uint128>>;
+    };
+
+    template<typename Rep>
+    struct accumulator_rep_impl<Rep, false, true> {
+      using type = std::conditional_t<(sizeof(Rep) < sizeof(double)), double, Rep>;
+    };
+
+  }  // namespace detail
+
+  // the rep sums of 'Rep' values are accumulated and returned in: 64 bits for narrower integers, 128 bits for 64-bit
+  // ones and at least double for floating-point; other reps are summed as they are
+  template<typename Rep>
+  using accumulator_rep = typename detail::accumulator_rep_impl<Rep>::type;
+
+  // product_unit
+
+  template<typename Unit1, typename Unit2>
+  using product_unit = unit<dimension_multiply<typename Unit1::dimension, typename Unit2::dimension>,
+                            std::ratio_multiply<typename Unit1::ratio, typename Unit2::ratio>>;
+
+  namespace detail {
+
+    // elements per scheduling unit; large enough to hide the cost of handing out a chunk
+    inline constexpr std::size_t reduce_grain = std::size_t(1) << 16;
+
+    // sums f(i) for i in [first, last); the unsequenced version keeps independent partial sums so that
+    // floating-point additions can be reassociated and vectorized
+    template<bool Unseq, typename Acc, typename F>
+    constexpr Acc sum_range(std::size_t first, std::size_t last, const F& f)
+    {
+      if constexpr(Unseq) {
+        constexpr std::size_t lanes = 8;
+        Acc partial[lanes]{};
+        std::size_t i = first;
+        for(; i + lanes <= last; i += lanes)
+          for(std::size_t j = 0; j < lanes; ++j) partial[j] += f(i + j);
+        for(; i < last; ++i) partial[0] += f(i);
+        for(std::size_t width = lanes / 2; width > 0; width /= 2)
+          for(std::size_t j = 0; j < width; ++j) partial[j] += partial[j + width];
+        return partial[0];
+      }
+      else {
+        Acc sum{};
+        for(std::size_t i = first; i < last; ++i) sum += f(i);
+        return sum;
+      }
+    }
+
+    // Splits [0, n) into chunks of 'reduce_grain' elements that worker threads claim from a shared counter, so faster
+    // threads take over more of the work. Partial sums are combined in chunk order, which keeps floating-point results
+    // independent of the thread count.
+    template<bool Unseq, typename Acc, typename F>
+    Acc parallel_sum(unsigned threads, std::size_t n, const F& f)
+    {
+      const std::size_t chunks = (n + reduce_grain - 1) / reduce_grain;
+      if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+      threads = static_cast<unsigned>(std::min<std::size_t>(threads, chunks));
+      if(threads <= 1) return sum_range<Unseq, Acc>(0, n, f);
+
+      std::vector<Acc> partial(chunks);
+      std::atomic<std::size_t> next{0};
+      auto work = [&] {
+        for(std::size_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < chunks;)
+          partial[c] = sum_range<Unseq, Acc>(c * reduce_grain, std::min(n, (c + 1) * reduce_grain), f);
+      };
+      std::vector<std::thread> pool;
+      pool.reserve(threads - 1);
+      try {
+        for(unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+      }
+      catch(...) {
+        // a thread failed to start: stop handing out chunks and join the running ones before giving up
+        next.store(chunks, std::memory_order_relaxed);
+        for(auto& t : pool) t.join();
+        throw;
+      }
+      work();
+      for(auto& t : pool) t.join();
+
+      Acc sum{};
+      for(const Acc& p : partial) sum += p;
+      return sum;
+    }
+
+    template<typename T>
+    inline constexpr bool is_quantity_span = false;
+
+    template<typename Q>
+    inline constexpr bool is_quantity_span<quantity_span<Q>> = true;
+
+    template<typename Range>
+    using range_element = std::remove_pointer_t<decltype(std::declval<const Range&>().data())>;
+
+    // contiguous ranges of quantities (quantity_span, quantity_array, std::vector, std::array, ...)
+    template<typename T, typename = void>
+    inline constexpr bool is_contiguous_quantity_range = false;
+
+    template<typename T>
+    inline constexpr bool
+        is_contiguous_quantity_range<T, std::void_t<range_element<T>, decltype(std::declval<const T&>().size())>> =
+            is_quantity<std::remove_cv_t<range_element<T>>>;
+
+    template<typename Range>
+    constexpr auto as_quantity_span(const Range& r)
+    {
+      return quantity_span<range_element<Range>>(r.data(), r.size());
+    }
+
+    template<typename Acc, typename Policy, typename F>
+    constexpr Acc policy_sum(const Policy& policy, std::size_t n, const F& f)
+    {
+      if constexpr(std::is_same_v<Policy, execution::sequenced_policy>)
+        return sum_range<false, Acc>(0, n, f);
+      else if constexpr(std::is_same_v<Policy, execution::unsequenced_policy>)
+        return sum_range<true, Acc>(0, n, f);
+      else if constexpr(std::is_same_v<Policy, execution::parallel_policy>)
+        return parallel_sum<false, Acc>(policy.threads, n, f);
+      else
+        return parallel_sum<true, Acc>(policy.threads, n, f);
+    }
+
+  }  // namespace detail
+
+  // reduce
+
+  // The sum of the values in their own unit, accumulated in accumulator_rep (so a sum of int64_t millimetres cannot
+  // overflow). The parallel policies run on short-lived threads and only pay off for inputs of a few hundred
+  // thousand elements or more; smaller inputs are summed on the calling thread.
+  template<typename Policy, typename Q, Requires<execution::is_execution_policy<Policy>> = true>
+  [[nodiscard]] constexpr auto reduce(const Policy& policy, quantity_span<Q> values)
+  {
+    using acc = accumulator_rep<typename quantity_span<Q>::rep>;
+    const Q* p = values.data();
+    return quantity<typename quantity_span<Q>::unit, acc>(
+        detail::policy_sum<acc>(policy, values.size(), [p](std::size_t i) { return acc(p[i].count()); }));
+  }
+
+  template<typename Q>
+  [[nodiscard]] constexpr auto reduce(quantity_span<Q> values)
+  {
+    return reduce(execution::seq, values);
+  }
+
+  template<typename Policy, typename Range,
+           Requires<execution::is_execution_policy<Policy> && detail::is_contiguous_quantity_range<Range> &&
+                    !detail::is_quantity_span<Range>> = true>
+  [[nodiscard]] constexpr auto reduce(const Policy& policy, const Range& values)
+  {
+    return reduce(policy, detail::as_quantity_span(values));
+  }
+
+  template<typename Range,
+           Requires<detail::is_contiguous_quantity_range<Range> && !detail::is_quantity_span<Range>> = true>
+  [[nodiscard]] constexpr auto reduce(const Range& values)
+  {
+    return reduce(execution::seq, detail::as_quantity_span(values));
+  }
+
+  // transform_reduce
+
+  // The inner product of two equally long sequences (std::system_error with std::errc::invalid_argument otherwise),
+  // in product_unit of their units (e.g. the distance travelled for velocities and time steps). Every product is
+  // computed in accumulator_rep, so it is exact for integers.
+  template<typename Policy, typename Q1, typename Q2, Requires<execution::is_execution_policy<Policy>> = true>
+  [[nodiscard]] constexpr auto transform_reduce(const Policy& policy, quantity_span<Q1> lhs, quantity_span<Q2> rhs)
+  {
+    using rep1 = typename quantity_span<Q1>::rep;
+    using rep2 = typename quantity_span<Q2>::rep;
+    using acc = accumulator_rep<decltype(std::declval<rep1>() * std::declval<rep2>())>;
+    const Q1* a = lhs.data();
+    const Q2* b = rhs.data();
+    using ret = quantity<product_unit<typename quantity_span<Q1>::unit, typename quantity_span<Q2>::unit>, acc>;
+    if(lhs.size() != rhs.size()) detail::throw_size_mismatch("transform_reduce sequences differ in size");
+    return ret(detail::policy_sum<acc>(policy, lhs.size(),
+                                       [a, b](std::size_t i) { return acc(a[i].count()) * acc(b[i].count()); }));
+  }
+
+  template<typename Q1, typename Q2>
+  [[nodiscard]] constexpr auto transform_reduce(quantity_span<Q1> lhs, quantity_span<Q2> rhs)
+  {
+    return transform_reduce(execution::seq, lhs, rhs);
+  }
+
+  template<typename Policy, typename Range1, typename Range2,
+           Requires<execution::is_execution_policy<Policy> && detail::is_contiguous_quantity_range<Range1> &&
+                    detail::is_contiguous_quantity_range<Range2> &&
+                    !(detail::is_quantity_span<Range1> && detail::is_quantity_span<Range2>)> = true>
+  [[nodiscard]] constexpr auto transform_reduce(const Policy& policy, const Range1& lhs, const Range2& rhs)
+  {
+    return transform_reduce(policy, detail::as_quantity_span(lhs), detail::as_quantity_span(rhs));
+  }
+
+  template<typename Range1, typename Range2,
+           Requires<detail::is_contiguous_quantity_range<Range1> && detail::is_contiguous_quantity_range<Range2> &&
+                    !(detail::is_quantity_span<Range1> && detail::is_quantity_span<Range2>)> = true>
+  [[nodiscard]] constexpr auto transform_reduce(const Range1& lhs, const Range2& rhs)
+  {
+    return transform_reduce(execution::seq, detail::as_quantity_span(lhs), detail::as_quantity_span(rhs));
+  }
+
+  // The sum of 'op' applied to every value; 'op' returns a quantity and the sum keeps its unit. 'op' is called
+  // concurrently by the parallel policies and must not throw.
+  template<typename Policy, typename Q, typename UnaryOp,
+           Requires<execution::is_execution_policy<Policy> && !detail::is_contiguous_quantity_range<UnaryOp>> = true>
+  [[nodiscard]] constexpr auto transform_reduce(const Policy& policy, quantity_span<Q> values, UnaryOp op)
+  {
+    using result = std::invoke_result_t<UnaryOp&, const Q&>;
+    static_assert(is_quantity<result>, "the transformation should return a units::quantity");
+    using acc = accumulator_rep<typename result::rep>;
+    const Q* p = values.data();
+    return quantity<typename result::unit, acc>(
+        detail::policy_sum<acc>(policy, values.size(), [p, &op](std::size_t i) { return acc(op(p[i]).count()); }));
+  }
+
+  template<typename Q, typename UnaryOp, Requires<!detail::is_contiguous_quantity_range<UnaryOp>> = true>
+  [[nodiscard]] constexpr auto transform_reduce(quantity_span<Q> values, UnaryOp op)
+  {
+    return transform_reduce(execution::seq, values, op);
+  }
+
+  template<typename Policy, typename Range, typename UnaryOp,
+           Requires<execution::is_execution_policy<Policy> && detail::is_contiguous_quantity_range<Range> &&
+                    !detail::is_quantity_span<Range> && !detail::is_contiguous_quantity_range<UnaryOp>> = true>
+  [[nodiscard]] constexpr auto transform_reduce(const Policy& policy, const Range& values, UnaryOp op)
+  {
+    return transform_reduce(policy, detail::as_quantity_span(values), op);
+  }
+
+  template<typename Range, typename UnaryOp,
+           Requires<detail::is_contiguous_quantity_range<Range> && !detail::is_quantity_span<Range> &&
+                    !detail::is_contiguous_quantity_range<UnaryOp>> = true>
+  [[nodiscard]] constexpr auto transform_reduce(const Range& values, UnaryOp op)
+  {
+    return transform_reduce(execution::seq, detail::as_quantity_span(values), op);
+  }
+
+}  // namespace units
@@ -0,0 +1,377 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity.h"
+#include "simd.h"
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <system_error>
+#include <vector>
+
+namespace units {
+
+  // aligned_allocator
+
+  namespace detail {
+
+    template<typename T, std::size_t Alignment>
+    struct aligned_allocator {
+      using value_type = T;
+
+      template<typename U>
+      struct rebind {
+        using other = aligned_allocator<U, Alignment>;
+      };
+
+      aligned_allocator() = default;
+      template<typename U>
+      constexpr aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+      [[nodiscard]] T* allocate(std::size_t n)
+      {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+      }
+      void deallocate(T* p, std::size_t) noexcept { ::operator delete(p, std::align_val_t(Alignment)); }
+
+      template<typename U>
+      [[nodiscard]] friend constexpr bool operator==(const aligned_allocator&, const aligned_allocator<U, Alignment>&)
+      {
+        return true;
+      }
+      template<typename U>
+      [[nodiscard]] friend constexpr bool operator!=(const aligned_allocator&, const aligned_allocator<U, Alignment>&)
+      {
+        return false;
+      }
+    };
+
+  }  // namespace detail
+
+  // quantity_span
+
+  template<typename Q>
+  class quantity_span {
+    Q* data_ = nullptr;
+    std::size_t size_ = 0;
+
+  public:
+    using element_type = Q;
+    using value_type = std::remove_cv_t<Q>;
+    using unit = typename value_type::unit;
+    using rep = typename value_type::rep;
+    using iterator = Q*;
+
+    static_assert(is_quantity<value_type>, "quantity_span should view units::quantity elements");
+
+    constexpr quantity_span() = default;
+    constexpr quantity_span(Q* data, std::size_t size) : data_(data), size_(size) {}
+
+    template<std::size_t N>
+    constexpr quantity_span(Q (&arr)[N]) : data_(arr), size_(N) {}
+
+    template<typename Q2,
+             Requires<std::is_convertible_v<Q2 (*)[], Q (*)[]>> = true>
+    constexpr quantity_span(const quantity_span<Q2>& s) : data_(s.data()), size_(s.size()) {}
+
+    [[nodiscard]] constexpr Q* data() const noexcept { return data_; }
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+
+    [[nodiscard]] constexpr iterator begin() const noexcept { return data_; }
+    [[nodiscard]] constexpr iterator end() const noexcept { return data_ + size_; }
+
+    [[nodiscard]] constexpr Q& operator[](std::size_t idx) const { return data_[idx]; }
+
+    [[nodiscard]] constexpr quantity_span subspan(std::size_t offset, std::size_t count) const
+    {
+      return quantity_span(data_ + offset, count);
+    }
+  };
+
+  // quantity_array
+
+  template<typename Unit, typename Rep = double>
+  class quantity_array {
+  public:
+    using value_type = quantity<Unit, Rep>;
+    using unit = Unit;
+    using rep = Rep;
+
+    // one cache line, enough for the widest (AVX-512) vector loads
+    static constexpr std::size_t alignment = 64;
+
+  private:
+    std::vector<value_type, detail::aligned_allocator<value_type, alignment>> data_;
+
+  public:
+    using iterator = typename decltype(data_)::iterator;
+    using const_iterator = typename decltype(data_)::const_iterator;
+
+    quantity_array() = default;
+    explicit quantity_array(std::size_t size) : data_(size) {}
+    quantity_array(std::size_t size, const value_type& v) : data_(size, v) {}
+    quantity_array(std::initializer_list<value_type> init) : data_(init) {}
+    explicit quantity_array(quantity_span<const value_type> s) : data_(s.begin(), s.end()) {}
+
+    [[nodiscard]] value_type* data() noexcept { return data_.data(); }
+    [[nodiscard]] const value_type* data() const noexcept { return data_.data(); }
+    [[nodiscard]] std::size_t size() const noexcept { return data_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return data_.empty(); }
+
+    [[nodiscard]] iterator begin() noexcept { return data_.begin(); }
+    [[nodiscard]] const_iterator begin() const noexcept { return data_.begin(); }
+    [[nodiscard]] iterator end() noexcept { return data_.end(); }
+    [[nodiscard]] const_iterator end() const noexcept { return data_.end(); }
+
+    [[nodiscard]] value_type& operator[](std::size_t idx) { return data_[idx]; }
+    [[nodiscard]] const value_type& operator[](std::size_t idx) const { return data_[idx]; }
+
+    void resize(std::size_t size) { data_.resize(size); }
+    void reserve(std::size_t size) { data_.reserve(size); }
+    void push_back(const value_type& v) { data_.push_back(v); }
+    void clear() noexcept { data_.clear(); }
+
+    operator quantity_span<value_type>() noexcept { return {data(), size()}; }
+    operator quantity_span<const value_type>() const noexcept { return {data(), size()}; }
+  };
+
+  // is_quantity_range
+
+  template<typename T>
+  inline constexpr bool is_quantity_range = false;
+
+  template<typename Q>
+  inline constexpr bool is_quantity_range<quantity_span<Q>> = true;
+
+  template<typename Unit, typename Rep>
+  inline constexpr bool is_quantity_range<quantity_array<Unit, Rep>> = true;
+
+  // elementwise arithmetic
+
+  // operations on two ranges require them to be equally long (std::system_error with std::errc::invalid_argument)
+  namespace detail {
+
+    template<typename T>
+    struct operand_traits {
+      using unit = void;
+      using rep = T;
+    };
+
+    template<typename Unit, typename Rep>
+    struct operand_traits<quantity<Unit, Rep>> {
+      using unit = Unit;
+      using rep = Rep;
+    };
+
+    template<typename T>
+    constexpr auto rep_data(T* p)
+    {
+      using rep = std::conditional_t<std::is_const_v<T>, const typename operand_traits<std::remove_cv_t<T>>::rep,
+                                     typename operand_traits<std::remove_cv_t<T>>::rep>;
+      if constexpr(is_quantity<std::remove_cv_t<T>>) {
+        static_assert(std::is_standard_layout_v<std::remove_cv_t<T>> && sizeof(T) == sizeof(rep));
+        return reinterpret_cast<rep*>(p);
+      }
+      else
+        return p;
+    }
+
+    template<typename Range>
+    using range_value = std::remove_cv_t<typename Range::value_type>;
+
+    // elementwise operations on ranges of different lengths
+    [[noreturn]] inline void throw_size_mismatch(const char* what)
+    {
+      throw std::system_error(std::make_error_code(std::errc::invalid_argument), what);
+    }
+
+    template<typename Q>
+    using quantity_array_of = quantity_array<typename Q::unit, typename Q::rep>;
+
+    // reps are combined directly when the scalar operator does so as well (no common_quantity rescaling involved)
+    template<simd::op O, typename Ret, typename T1, typename T2>
+    inline constexpr bool vectorizable_op =
+        std::is_same_v<typename Ret::rep, typename operand_traits<T1>::rep> &&
+        std::is_same_v<typename Ret::rep, typename operand_traits<T2>::rep> &&
+        simd::is_vectorizable<typename Ret::rep> &&
+        (O == simd::op::mul || O == simd::op::div ||
+         std::is_same_v<typename operand_traits<T1>::unit, typename operand_traits<T2>::unit>);
+
+    template<simd::op O, bool LhsScalar, bool RhsScalar, typename Ret, typename T1, typename T2>
+    void transform(const T1* lhs, const T2* rhs, quantity_span<Ret> out)
+    {
+      if constexpr(vectorizable_op<O, Ret, T1, T2>)
+        simd::transform<O, LhsScalar, RhsScalar>(rep_data(lhs), rep_data(rhs), rep_data(out.data()), out.size());
+      else
+        for(std::size_t i = 0; i < out.size(); ++i)
+          out[i] = Ret(simd::apply<O>(lhs[LhsScalar ? 0 : i], rhs[RhsScalar ? 0 : i]));
+    }
+
+    template<simd::op O, typename Range1, typename Range2,
+             typename Ret = decltype(simd::apply<O>(std::declval<range_value<Range1>>(), std::declval<range_value<Range2>>()))>
+    quantity_array_of<Ret> transform(const Range1& lhs, const Range2& rhs)
+    {
+      if(lhs.size() != rhs.size()) throw_size_mismatch("quantity_array operands differ in size");
+      quantity_array_of<Ret> ret(lhs.size());
+      transform<O, false, false>(lhs.data(), rhs.data(), quantity_span<Ret>(ret));
+      return ret;
+    }
+
+    template<simd::op O, typename Range, typename Rep,
+             typename Ret = decltype(simd::apply<O>(std::declval<range_value<Range>>(), std::declval<Rep>()))>
+    quantity_array_of<Ret> transform_scalar_rhs(const Range& lhs, const Rep& v)
+    {
+      quantity_array_of<Ret> ret(lhs.size());
+      if constexpr(std::is_arithmetic_v<Rep> && std::is_same_v<typename Ret::rep, typename Range::rep>) {
+        // the usual arithmetic conversions would convert 'v' to the result rep anyway
+        const auto cv = static_cast<typename Ret::rep>(v);
+        transform<O, false, true>(lhs.data(), &cv, quantity_span<Ret>(ret));
+      }
+      else
+        transform<O, false, true>(lhs.data(), &v, quantity_span<Ret>(ret));
+      return ret;
+    }
+
+    template<simd::op O, typename Rep, typename Range,
+             typename Ret = decltype(simd::apply<O>(std::declval<Rep>(), std::declval<range_value<Range>>()))>
+    quantity_array_of<Ret> transform_scalar_lhs(const Rep& v, const Range& rhs)
+    {
+      quantity_array_of<Ret> ret(rhs.size());
+      if constexpr(std::is_arithmetic_v<Rep> && std::is_same_v<typename Ret::rep, typename Range::rep>) {
+        const auto cv = static_cast<typename Ret::rep>(v);
+        transform<O, true, false>(&cv, rhs.data(), quantity_span<Ret>(ret));
+      }
+      else
+        transform<O, true, false>(&v, rhs.data(), quantity_span<Ret>(ret));
+      return ret;
+    }
+
+  }  // namespace detail
+
+  template<typename Range1, typename Range2,
+           Requires<is_quantity_range<Range1> && is_quantity_range<Range2>> = true,
+           typename Ret = decltype(std::declval<detail::range_value<Range1>>() + std::declval<detail::range_value<Range2>>())>
+  [[nodiscard]] auto operator+(const Range1& lhs, const Range2& rhs)
+  {
+    return detail::transform<detail::simd::op::add>(lhs, rhs);
+  }
+
+  template<typename Range1, typename Range2,
+           Requires<is_quantity_range<Range1> && is_quantity_range<Range2>> = true,
+           typename Ret = decltype(std::declval<detail::range_value<Range1>>() - std::declval<detail::range_value<Range2>>())>
+  [[nodiscard]] auto operator-(const Range1& lhs, const Range2& rhs)
+  {
+    return detail::transform<detail::simd::op::sub>(lhs, rhs);
+  }
+
+  template<typename Range1, typename Range2,
+           Requires<is_quantity_range<Range1> && is_quantity_range<Range2>> = true,
+           typename Ret = decltype(std::declval<detail::range_value<Range1>>() * std::declval<detail::range_value<Range2>>()),
+           Requires<is_quantity<Ret>> = true>
+  [[nodiscard]] auto operator*(const Range1& lhs, const Range2& rhs)
+  {
+    return detail::transform<detail::simd::op::mul>(lhs, rhs);
+  }
+
+  template<typename Range1, typename Range2,
+           Requires<is_quantity_range<Range1> && is_quantity_range<Range2>> = true,
+           typename Ret = decltype(std::declval<detail::range_value<Range1>>() / std::declval<detail::range_value<Range2>>()),
+           Requires<is_quantity<Ret>> = true>
+  [[nodiscard]] auto operator/(const Range1& lhs, const Range2& rhs)
+  {
+    return detail::transform<detail::simd::op::div>(lhs, rhs);
+  }
+
+  template<typename Range, typename Rep,
+           Requires<is_quantity_range<Range> && !is_quantity_range<Rep> && !is_quantity<Rep>> = true,
+           typename Ret = decltype(std::declval<detail::range_value<Range>>() * std::declval<Rep>())>
+  [[nodiscard]] auto operator*(const Range& lhs, const Rep& v)
+  {
+    return detail::transform_scalar_rhs<detail::simd::op::mul>(lhs, v);
+  }
+
+  template<typename Rep, typename Range,
+           Requires<is_quantity_range<Range> && !is_quantity_range<Rep> && !is_quantity<Rep>> = true,
+           typename Ret = decltype(std::declval<Rep>() * std::declval<detail::range_value<Range>>())>
+  [[nodiscard]] auto operator*(const Rep& v, const Range& rhs)
+  {
+    return detail::transform_scalar_lhs<detail::simd::op::mul>(v, rhs);
+  }
+
+  template<typename Range, typename Rep,
+           Requires<is_quantity_range<Range> && !is_quantity_range<Rep> && !is_quantity<Rep>> = true,
+           typename Ret = decltype(std::declval<detail::range_value<Range>>() / std::declval<Rep>())>
+  [[nodiscard]] auto operator/(const Range& lhs, const Rep& v)
+  {
+    return detail::transform_scalar_rhs<detail::simd::op::div>(lhs, v);
+  }
+
+  template<typename Rep, typename Range,
+           Requires<is_quantity_range<Range> && !is_quantity_range<Rep> && !is_quantity<Rep>> = true,
+           typename Ret = decltype(std::declval<Rep>() / std::declval<detail::range_value<Range>>())>
+  [[nodiscard]] auto operator/(const Rep& v, const Range& rhs)
+  {
+    return detail::transform_scalar_lhs<detail::simd::op::div>(v, rhs);
+  }
+
+  // quantity_cast
+
+  // converts all values with the same operations as the scalar quantity_cast (bit-identical results); 'from' and 'to'
+  // must be equally long (std::system_error with std::errc::invalid_argument)
+  template<typename To, typename Range,
+           Requires<is_quantity<To> && is_quantity_range<Range>> = true>
+  void quantity_cast(const Range& from, quantity_span<To> to)
+  {
+    using from_type = detail::range_value<Range>;
+    using c_ratio = detail::cast_ratio<To, typename from_type::unit>;
+    using c_rep = detail::cast_rep<To, typename from_type::rep>;
+    if(from.size() != to.size()) detail::throw_size_mismatch("quantity_cast ranges differ in size");
+    if constexpr(detail::simd::is_vectorizable<typename from_type::rep> && detail::simd::is_vectorizable<typename To::rep>)
+      detail::simd::scale<c_rep, c_ratio::num, c_ratio::den>(detail::rep_data(from.data()), detail::rep_data(to.data()),
+                                                            to.size());
+    else
+      for(std::size_t i = 0; i < to.size(); ++i) to[i] = quantity_cast<To>(from[i]);
+  }
+
+  // in-place variant; returns the same storage viewed in the target unit
+  template<typename To, typename Range,
+           Requires<is_quantity<To> && is_quantity_range<std::remove_reference_t<Range>> &&
+                    !std::is_const_v<std::remove_pointer_t<decltype(std::declval<Range&>().data())>>> = true>
+  quantity_span<To> quantity_cast(Range&& data)
+  {
+    using from_type = detail::range_value<std::remove_reference_t<Range>>;
+    static_assert(std::is_same_v<typename from_type::rep, typename To::rep>, "in-place cast cannot change the rep");
+    static_assert(std::is_standard_layout_v<from_type> && std::is_standard_layout_v<To> && sizeof(from_type) == sizeof(To));
+    using c_ratio = detail::cast_ratio<To, typename from_type::unit>;
+    using c_rep = detail::cast_rep<To, typename from_type::rep>;
+    auto* reps = detail::rep_data(data.data());
+    if constexpr(detail::simd::is_vectorizable<typename To::rep>)
+      detail::simd::scale<c_rep, c_ratio::num, c_ratio::den>(reps, reps, data.size());
+    else
+      for(std::size_t i = 0; i < data.size(); ++i) reps[i] = quantity_cast<To>(data[i]).count();
+    return quantity_span<To>(reinterpret_cast<To*>(data.data()), data.size());
+  }
+
+}  // namespace units
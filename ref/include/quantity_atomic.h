@@ -0,0 +1,180 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity.h"
+#include <atomic>
+#include <type_traits>
+#if __has_include(<version>)
+#include <version>
+#endif
+
+namespace units::detail {
+
+  // quantities that convert to 'Q' without losing precision (the same rule as the implicit converting constructor)
+  template<typename Q, typename Q2>
+  inline constexpr bool atomic_operand = false;
+
+  template<typename Unit, typename Rep, typename Unit2, typename Rep2>
+  inline constexpr bool atomic_operand<quantity<Unit, Rep>, quantity<Unit2, Rep2>> =
+      std::is_convertible_v<quantity<Unit2, Rep2>, quantity<Unit, Rep>>;
+
+}  // namespace units::detail
+
+namespace std {
+
+  // A lock-free (when std::atomic<Rep> is) atomic quantity. fetch_add() and fetch_sub() take a quantity in any unit
+  // of the same dimension that converts losslessly to the stored one; the conversion is done before the atomic
+  // operation, so a compile-time ratio costs at most one multiplication. Floating-point reps use a compare-exchange
+  // loop where the library does not provide fetch_add() for them.
+  template<typename Unit, typename Rep>
+  struct atomic<units::quantity<Unit, Rep>> {
+    using value_type = units::quantity<Unit, Rep>;
+    using difference_type = value_type;
+
+  private:
+    std::atomic<Rep> value_;
+
+    template<typename Q2>
+    using operand = std::enable_if_t<units::detail::atomic_operand<value_type, Q2>, bool>;
+
+    Rep add(Rep v, std::memory_order order) noexcept
+    {
+#if !defined(__cpp_lib_atomic_float)
+      if constexpr(std::is_floating_point_v<Rep>) {
+        Rep expected = value_.load(std::memory_order_relaxed);
+        while(!value_.compare_exchange_weak(expected, expected + v, order, std::memory_order_relaxed)) {
+        }
+        return expected;
+      }
+      else
+#endif
+        return value_.fetch_add(v, order);
+    }
+
+    Rep sub(Rep v, std::memory_order order) noexcept
+    {
+#if !defined(__cpp_lib_atomic_float)
+      if constexpr(std::is_floating_point_v<Rep>) {
+        Rep expected = value_.load(std::memory_order_relaxed);
+        while(!value_.compare_exchange_weak(expected, expected - v, order, std::memory_order_relaxed)) {
+        }
+        return expected;
+      }
+      else
+#endif
+        return value_.fetch_sub(v, order);
+    }
+
+  public:
+    static constexpr bool is_always_lock_free = std::atomic<Rep>::is_always_lock_free;
+
+    atomic() noexcept = default;
+    constexpr atomic(value_type q) noexcept : value_(q.count()) {}
+    atomic(const atomic&) = delete;
+    atomic& operator=(const atomic&) = delete;
+    atomic& operator=(const atomic&) volatile = delete;
+
+    [[nodiscard]] bool is_lock_free() const noexcept { return value_.is_lock_free(); }
+
+    void store(value_type q, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+      value_.store(q.count(), order);
+    }
+    [[nodiscard]] value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept
+    {
+      return value_type(value_.load(order));
+    }
+    operator value_type() const noexcept { return load(); }
+    value_type operator=(value_type q) noexcept
+    {
+      store(q);
+      return q;
+    }
+
+    value_type exchange(value_type q, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+      return value_type(value_.exchange(q.count(), order));
+    }
+
+    bool compare_exchange_weak(value_type& expected, value_type desired, std::memory_order success,
+                               std::memory_order failure) noexcept
+    {
+      Rep e = expected.count();
+      const bool ok = value_.compare_exchange_weak(e, desired.count(), success, failure);
+      expected = value_type(e);
+      return ok;
+    }
+    bool compare_exchange_weak(value_type& expected, value_type desired,
+                               std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+      Rep e = expected.count();
+      const bool ok = value_.compare_exchange_weak(e, desired.count(), order);
+      expected = value_type(e);
+      return ok;
+    }
+    bool compare_exchange_strong(value_type& expected, value_type desired, std::memory_order success,
+                                 std::memory_order failure) noexcept
+    {
+      Rep e = expected.count();
+      const bool ok = value_.compare_exchange_strong(e, desired.count(), success, failure);
+      expected = value_type(e);
+      return ok;
+    }
+    bool compare_exchange_strong(value_type& expected, value_type desired,
+                                 std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+      Rep e = expected.count();
+      const bool ok = value_.compare_exchange_strong(e, desired.count(), order);
+      expected = value_type(e);
+      return ok;
+    }
+
+    template<typename Unit2, typename Rep2, operand<units::quantity<Unit2, Rep2>> = true>
+    value_type fetch_add(const units::quantity<Unit2, Rep2>& q,
+                         std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+      return value_type(add(value_type(q).count(), order));
+    }
+    template<typename Unit2, typename Rep2, operand<units::quantity<Unit2, Rep2>> = true>
+    value_type fetch_sub(const units::quantity<Unit2, Rep2>& q,
+                         std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+      return value_type(sub(value_type(q).count(), order));
+    }
+
+    template<typename Unit2, typename Rep2, operand<units::quantity<Unit2, Rep2>> = true>
+    value_type operator+=(const units::quantity<Unit2, Rep2>& q) noexcept
+    {
+      const value_type v(q);
+      return value_type(add(v.count(), std::memory_order_seq_cst) + v.count());
+    }
+    template<typename Unit2, typename Rep2, operand<units::quantity<Unit2, Rep2>> = true>
+    value_type operator-=(const units::quantity<Unit2, Rep2>& q) noexcept
+    {
+      const value_type v(q);
+      return value_type(sub(v.count(), std::memory_order_seq_cst) - v.count());
+    }
+  };
+
+}  // namespace std
@@ -0,0 +1,102 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "frequency.h"
+#include "velocity.h"
+#include <cstdint>
+
+// Opt-in catalogue of the standard quantities. Including this header declares the quantities of the standard
+// length, time, velocity and frequency units with the std::int64_t, double and long double representations, and
+// their conversions to the coherent unit of each dimension, as explicit instantiations that are defined once in
+// ref/src/quantity_catalogue.cpp. Translation units including it do not emit their own copies of those members.
+
+#ifndef UNITS_CATALOGUE_EXTERN
+#define UNITS_CATALOGUE_EXTERN extern
+#endif
+
+#define UNITS_CATALOGUE_QUANTITY(Unit)                                 \
+  UNITS_CATALOGUE_EXTERN template class quantity<Unit, std::int64_t>; \
+  UNITS_CATALOGUE_EXTERN template class quantity<Unit, double>;       \
+  UNITS_CATALOGUE_EXTERN template class quantity<Unit, long double>;
+
+#define UNITS_CATALOGUE_CONVERSION(To, From, Rep) \
+  UNITS_CATALOGUE_EXTERN template quantity<To, Rep>::quantity(const quantity<From, Rep>&);
+
+// integral conversions are implicit only towards a finer unit
+#define UNITS_CATALOGUE_CONVERSIONS(To, From)          \
+  UNITS_CATALOGUE_CONVERSION(To, From, double)         \
+  UNITS_CATALOGUE_CONVERSION(To, From, long double)
+
+#define UNITS_CATALOGUE_ALL_CONVERSIONS(To, From)      \
+  UNITS_CATALOGUE_CONVERSION(To, From, std::int64_t)   \
+  UNITS_CATALOGUE_CONVERSIONS(To, From)
+
+namespace units {
+
+  // length
+  UNITS_CATALOGUE_QUANTITY(millimetre)
+  UNITS_CATALOGUE_QUANTITY(metre)
+  UNITS_CATALOGUE_QUANTITY(kilometre)
+  UNITS_CATALOGUE_CONVERSIONS(metre, millimetre)
+  UNITS_CATALOGUE_ALL_CONVERSIONS(metre, kilometre)
+
+  // time
+  UNITS_CATALOGUE_QUANTITY(nanosecond)
+  UNITS_CATALOGUE_QUANTITY(microsecond)
+  UNITS_CATALOGUE_QUANTITY(millisecond)
+  UNITS_CATALOGUE_QUANTITY(second)
+  UNITS_CATALOGUE_QUANTITY(minute)
+  UNITS_CATALOGUE_QUANTITY(hour)
+  UNITS_CATALOGUE_CONVERSIONS(second, nanosecond)
+  UNITS_CATALOGUE_CONVERSIONS(second, microsecond)
+  UNITS_CATALOGUE_CONVERSIONS(second, millisecond)
+  UNITS_CATALOGUE_ALL_CONVERSIONS(second, minute)
+  UNITS_CATALOGUE_ALL_CONVERSIONS(second, hour)
+
+  // velocity
+  UNITS_CATALOGUE_QUANTITY(meter_per_second)
+  UNITS_CATALOGUE_QUANTITY(kilometer_per_hour)
+  UNITS_CATALOGUE_QUANTITY(mile_per_hour)
+  UNITS_CATALOGUE_CONVERSIONS(meter_per_second, kilometer_per_hour)
+  UNITS_CATALOGUE_CONVERSIONS(meter_per_second, mile_per_hour)
+
+  // frequency
+  UNITS_CATALOGUE_QUANTITY(millihertz)
+  UNITS_CATALOGUE_QUANTITY(hertz)
+  UNITS_CATALOGUE_QUANTITY(kilohertz)
+  UNITS_CATALOGUE_QUANTITY(megahertz)
+  UNITS_CATALOGUE_QUANTITY(gigahertz)
+  UNITS_CATALOGUE_QUANTITY(terahertz)
+  UNITS_CATALOGUE_CONVERSIONS(hertz, millihertz)
+  UNITS_CATALOGUE_ALL_CONVERSIONS(hertz, kilohertz)
+  UNITS_CATALOGUE_ALL_CONVERSIONS(hertz, megahertz)
+  UNITS_CATALOGUE_ALL_CONVERSIONS(hertz, gigahertz)
+  UNITS_CATALOGUE_ALL_CONVERSIONS(hertz, terahertz)
+
+}  // namespace units
+
+#undef UNITS_CATALOGUE_ALL_CONVERSIONS
+#undef UNITS_CATALOGUE_CONVERSIONS
+#undef UNITS_CATALOGUE_CONVERSION
+#undef UNITS_CATALOGUE_QUANTITY
@@ -0,0 +1,403 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "frequency.h"
+#include "length.h"
+#include "time.h"
+#include "unit_symbol.h"
+#include "velocity.h"
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+namespace units {
+
+  namespace detail {
+
+    // unit_suffix
+
+    template<typename Unit>
+    inline constexpr std::string_view unit_suffix{};
+
+    template<> inline constexpr std::string_view unit_suffix<millimetre> = "mm";
+    template<> inline constexpr std::string_view unit_suffix<metre> = "m";
+    template<> inline constexpr std::string_view unit_suffix<kilometre> = "km";
+
+    template<> inline constexpr std::string_view unit_suffix<nanosecond> = "ns";
+    template<> inline constexpr std::string_view unit_suffix<microsecond> = "us";
+    template<> inline constexpr std::string_view unit_suffix<millisecond> = "ms";
+    template<> inline constexpr std::string_view unit_suffix<second> = "s";
+    template<> inline constexpr std::string_view unit_suffix<minute> = "min";
+    template<> inline constexpr std::string_view unit_suffix<hour> = "h";
+
+    template<> inline constexpr std::string_view unit_suffix<meter_per_second> = "mps";
+    template<> inline constexpr std::string_view unit_suffix<kilometer_per_hour> = "kmph";
+    template<> inline constexpr std::string_view unit_suffix<mile_per_hour> = "mph";
+
+    template<> inline constexpr std::string_view unit_suffix<millihertz> = "mHz";
+    template<> inline constexpr std::string_view unit_suffix<hertz> = "Hz";
+    template<> inline constexpr std::string_view unit_suffix<kilohertz> = "kHz";
+    template<> inline constexpr std::string_view unit_suffix<megahertz> = "MHz";
+    template<> inline constexpr std::string_view unit_suffix<gigahertz> = "GHz";
+    template<> inline constexpr std::string_view unit_suffix<terahertz> = "THz";
+
+    template<typename... Units>
+    struct unit_list {};
+
+    // units recognized by from_chars by their literal suffixes and their symbols
+    using suffixed_units = unit_list<millimetre, metre, kilometre,
+                                     nanosecond, microsecond, millisecond, second, minute, hour,
+                                     meter_per_second, kilometer_per_hour, mile_per_hour,
+                                     millihertz, hertz, kilohertz, megahertz, gigahertz, terahertz>;
+
+    // scan_decimal
+
+    // [-]digits[.digits][(e|E)[+|-]digits] as a 64-bit mantissa with up to 19 significant digits and an exponent
+    struct decimal {
+      std::uint64_t mantissa = 0;
+      int exponent = 0;
+      bool negative = false;
+    };
+
+    constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    // SWAR scanning of up to 8 ASCII digits at once; the unrolled byte-wise load is merged into a single unaligned load
+    constexpr std::uint64_t load_eight(const char* p)
+    {
+      auto byte = [p](int i) { return std::uint64_t(static_cast<unsigned char>(p[i])) << (8 * i); };
+      return byte(0) | byte(1) | byte(2) | byte(3) | byte(4) | byte(5) | byte(6) | byte(7);
+    }
+
+    inline constexpr std::uint64_t pow10_table[] = {1,         10,         100,         1'000,      10'000,
+                                                    100'000,   1'000'000,  10'000'000,  100'000'000};
+
+    // the number of digits at the beginning of the 8 characters in 'v'
+    constexpr int leading_digits(std::uint64_t v)
+    {
+      // zero bytes for the digits (carries only move from a non-digit to the bytes after it)
+      const std::uint64_t non_digits =
+          ((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ^ 0x3333333333333333;
+      if(non_digits == 0) return 8;
+#if defined(__GNUC__)
+      return __builtin_ctzll(non_digits) / 8;
+#else
+      int n = 0;
+      while(((non_digits >> (8 * n)) & 0xFF) == 0) ++n;
+      return n;
+#endif
+    }
+
+    // the value of the first 'n' (1 <= n <= 8) digits in 'v'
+    constexpr std::uint64_t digits_value(std::uint64_t v, int n)
+    {
+      if(n < 8) v = (v << (8 * (8 - n))) | (0x3030303030303030 >> (8 * n));  // left-padded with '0'
+      v -= 0x3030303030303030;
+      v = (v * 10) + (v >> 8);
+      return (((v & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+              (((v >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+    }
+
+    constexpr const char* scan_digits(const char* p, const char* last, decimal& d, bool fraction, bool& any)
+    {
+      constexpr std::uint64_t swar_limit = 100'000'000'000;          // mantissa * 10^8 + 99999999 < 10^19
+      constexpr std::uint64_t digit_limit = 1'000'000'000'000'000'000;  // mantissa * 10 + 9 < 10^19
+      while(last - p >= 8 && d.mantissa < swar_limit) {
+        const std::uint64_t v = load_eight(p);
+        const int n = leading_digits(v);
+        if(n == 0) return p;
+        d.mantissa = d.mantissa * pow10_table[n] + digits_value(v, n);
+        if(fraction) d.exponent -= n;
+        p += n;
+        any = true;
+        if(n < 8) return p;
+      }
+      for(; p != last && is_digit(*p); ++p) {
+        any = true;
+        if(d.mantissa < digit_limit) {
+          d.mantissa = d.mantissa * 10 + std::uint64_t(*p - '0');
+          if(fraction) --d.exponent;
+        }
+        else if(!fraction)
+          ++d.exponent;
+      }
+      return p;
+    }
+
+    // returns 'first' if there is no number
+    constexpr const char* scan_decimal(const char* first, const char* last, decimal& d)
+    {
+      const char* p = first;
+      d.negative = p != last && *p == '-';
+      if(d.negative) ++p;
+
+      bool any = false;
+      p = scan_digits(p, last, d, false, any);
+      if(p != last && *p == '.') p = scan_digits(p + 1, last, d, true, any);
+      if(!any) return first;
+
+      if(p != last && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        const bool negative = e != last && *e == '-';
+        if(e != last && (*e == '-' || *e == '+')) ++e;
+        if(e != last && is_digit(*e)) {
+          int exponent = 0;
+          for(; e != last && is_digit(*e); ++e)
+            if(exponent < 10'000) exponent = exponent * 10 + (*e - '0');
+          d.exponent += negative ? -exponent : exponent;
+          p = e;
+        }
+      }
+      return p;
+    }
+
+    constexpr bool is_symbol_char(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+    // symbols of derived units also contain the operators and exponents ("m/s", "km/h", "m^2")
+    constexpr bool is_derived_symbol_char(char c)
+    {
+      return is_symbol_char(c) || is_digit(c) || c == '/' || c == '*' || c == '^';
+    }
+
+    // decimal_to_floating
+
+    // the largest k with 5^k exactly representable, so that 10^k is exact as well
+    template<typename F>
+    constexpr int max_exact_pow10()
+    {
+      constexpr int digits = std::numeric_limits<F>::digits < 64 ? std::numeric_limits<F>::digits : 63;
+      int k = 0;
+      for(std::uint64_t p = 1; p <= (std::uint64_t(1) << digits) / 5; p *= 5) ++k;
+      return k;
+    }
+
+    // Clinger's fast path when both the mantissa and the power of 10 are exact, std::from_chars otherwise
+    template<typename F>
+    constexpr std::errc decimal_to_floating(const decimal& d, const char* first, const char* last, F& value)
+    {
+      constexpr int max_exponent = max_exact_pow10<F>();
+      constexpr int digits = std::numeric_limits<F>::digits;
+      constexpr std::uint64_t max_mantissa = digits < 64 ? std::uint64_t(1) << digits : ~std::uint64_t(0);
+      if(d.mantissa <= max_mantissa && d.exponent >= -max_exponent && d.exponent <= max_exponent) {
+        F pow10 = 1;
+        for(int i = 0; i < (d.exponent < 0 ? -d.exponent : d.exponent); ++i) pow10 *= 10;
+        const F m = static_cast<F>(d.mantissa);
+        value = d.exponent < 0 ? m / pow10 : m * pow10;
+        if(d.negative) value = -value;
+        return std::errc{};
+      }
+      return std::from_chars(first, last, value).ec;
+    }
+
+    // convert_count
+
+    template<typename To, typename From>
+    constexpr std::errc convert_count(const decimal& d, const char* first, const char* last, typename To::rep& count)
+    {
+      using rep = typename To::rep;
+      if constexpr(treat_as_floating_point<rep>) {
+        using F = std::conditional_t<(sizeof(rep) > sizeof(double)), long double, double>;
+        F value = 0;
+        if(const std::errc ec = decimal_to_floating(d, first, last, value); ec != std::errc{}) return ec;
+        const rep result = quantity_cast<To>(quantity<From, F>(value)).count();
+        if(!(result >= std::numeric_limits<rep>::lowest() && result <= std::numeric_limits<rep>::max()))
+          return std::errc::result_out_of_range;
+        count = result;
+        return std::errc{};
+      }
+#if defined(__SIZEOF_INT128__)
+      else {
+        // exact |mantissa| * 10^exponent * num / den truncated toward zero, like quantity_cast
+        using ratio = cast_ratio<To, From>;
+        constexpr uint128 max128 = ~uint128(0);
+        uint128 num = uint128(d.mantissa) * std::uint64_t(ratio::num);
+        uint128 den = std::uint64_t(ratio::den);
+        for(int i = 0; i < d.exponent; ++i) {
+          if(num > max128 / 10) return num == 0 ? std::errc{} : std::errc::result_out_of_range;
+          num *= 10;
+        }
+        for(int i = 0; i > d.exponent && num != 0; --i) {
+          if(den > num / 10) num = 0;
+          den *= 10;
+        }
+        const uint128 magnitude = num / den;
+        const uint128 limit = uint128(std::numeric_limits<rep>::max()) + (d.negative ? 1 : 0);
+        if(magnitude > limit) return std::errc::result_out_of_range;
+        if(d.negative && std::numeric_limits<rep>::is_signed)
+          count = magnitude == limit ? std::numeric_limits<rep>::min() : static_cast<rep>(-static_cast<rep>(magnitude));
+        else if(d.negative && magnitude != 0)
+          return std::errc::result_out_of_range;
+        else
+          count = static_cast<rep>(magnitude);
+        return std::errc{};
+      }
+#else
+      else {
+        long double value = 0;
+        if(const std::errc ec = decimal_to_floating(d, first, last, value); ec != std::errc{}) return ec;
+        using target = quantity<typename To::unit, long double>;
+        const long double result = quantity_cast<target>(quantity<From, long double>(value)).count();
+        if(!(result >= std::numeric_limits<rep>::lowest() && result <= std::numeric_limits<rep>::max()))
+          return std::errc::result_out_of_range;
+        count = static_cast<rep>(result);
+        return std::errc{};
+      }
+#endif
+    }
+
+    template<typename To, typename From>
+    constexpr std::from_chars_result parse_as(const decimal& d, const char* first, const char* number_last,
+                                              const char* symbol_last, To& q)
+    {
+      if constexpr(!same_dim<typename To::unit, From>)
+        return {symbol_last, std::errc::argument_out_of_domain};
+      else {
+        typename To::rep count{};
+        if(const std::errc ec = convert_count<To, From>(d, first, number_last, count); ec != std::errc{})
+          return {symbol_last, ec};
+        q = To(count);
+        return {symbol_last, std::errc{}};
+      }
+    }
+
+    template<typename To, typename... Units>
+    constexpr std::from_chars_result parse_suffixed(unit_list<Units...>, std::string_view symbol, const decimal& d,
+                                                    const char* first, const char* number_last, const char* symbol_last,
+                                                    To& q)
+    {
+      std::from_chars_result result{first, std::errc::invalid_argument};
+      (void)(((symbol == unit_suffix<Units> || symbol == unit_symbol<Units>) &&
+              (result = parse_as<To, Units>(d, first, number_last, symbol_last, q), true)) || ...);
+      return result;
+    }
+
+  }  // namespace detail
+
+  // from_chars
+
+  // Parses "<number>[ ]<symbol>" where the symbol is a literal suffix or a unit symbol ("12.5 km", "300ms",
+  // "120 kmph", "120 km/h") and converts the value to the unit of 'q'. Like std::from_chars it never allocates, does not skip leading
+  // whitespace and leaves 'q' untouched on error:
+  //  - std::errc::invalid_argument         no number or an unknown symbol, 'ptr' == 'first'
+  //  - std::errc::argument_out_of_domain   the symbol has a different dimension than 'q'
+  //  - std::errc::result_out_of_range      the converted value does not fit in the representation of 'q'
+  template<typename Unit, typename Rep>
+  constexpr std::from_chars_result from_chars(const char* first, const char* last, quantity<Unit, Rep>& q)
+  {
+    static_assert(std::is_arithmetic_v<Rep>, "from_chars supports arithmetic representations only");
+
+    detail::decimal d;
+    const char* p = detail::scan_decimal(first, last, d);
+    if(p == first) return {first, std::errc::invalid_argument};
+    const char* number_last = p;
+
+    while(p != last && (*p == ' ' || *p == '\t')) ++p;
+    const char* symbol_first = p;
+    while(p != last && detail::is_symbol_char(*p)) ++p;
+    const char* alpha_last = p;
+    if(p != symbol_first)
+      while(p != last && detail::is_derived_symbol_char(*p)) ++p;
+
+    auto symbol = [&](const char* symbol_last) {
+      return std::string_view(symbol_first, static_cast<std::size_t>(symbol_last - symbol_first));
+    };
+    std::from_chars_result result =
+        detail::parse_suffixed(detail::suffixed_units{}, symbol(p), d, first, number_last, p, q);
+    if(result.ec == std::errc::invalid_argument && p != alpha_last)  // "10 m/x" still reads "10 m"
+      result = detail::parse_suffixed(detail::suffixed_units{}, symbol(alpha_last), d, first, number_last,
+                                      alpha_last, q);
+    return result;
+  }
+
+  namespace detail {
+
+    // appends " <symbol>" after the number written by std::to_chars
+    template<typename Unit>
+    std::to_chars_result append_symbol(std::to_chars_result number, char* last)
+    {
+      constexpr std::string_view symbol = unit_symbol<Unit>;
+      if(number.ec != std::errc() || symbol.empty()) return number;
+      if(static_cast<std::size_t>(last - number.ptr) < symbol.size() + 1) return {last, std::errc::value_too_large};
+      *number.ptr++ = ' ';
+      for(char c : symbol) *number.ptr++ = c;
+      return number;
+    }
+
+  }  // namespace detail
+
+  // to_chars
+
+  // Writes "<number> <symbol>" ("12.5 km", "300 ms", "120 km/h") to [first, last) without allocating. The number
+  // is formatted by std::to_chars with the same optional format and precision; a quantity of a dimensionless unit
+  // is written without a symbol. Returns {last, std::errc::value_too_large} if the buffer is too small.
+  template<typename Unit, typename Rep>
+  std::to_chars_result to_chars(char* first, char* last, const quantity<Unit, Rep>& q)
+  {
+    static_assert(std::is_arithmetic_v<Rep>, "to_chars supports arithmetic representations only");
+    return detail::append_symbol<Unit>(std::to_chars(first, last, q.count()), last);
+  }
+
+  template<typename Unit, typename Rep>
+  std::to_chars_result to_chars(char* first, char* last, const quantity<Unit, Rep>& q, std::chars_format fmt)
+  {
+    static_assert(std::is_floating_point_v<Rep>, "a format is supported for floating-point representations only");
+    return detail::append_symbol<Unit>(std::to_chars(first, last, q.count(), fmt), last);
+  }
+
+  template<typename Unit, typename Rep>
+  std::to_chars_result to_chars(char* first, char* last, const quantity<Unit, Rep>& q, std::chars_format fmt,
+                                int precision)
+  {
+    static_assert(std::is_floating_point_v<Rep>, "a format is supported for floating-point representations only");
+    return detail::append_symbol<Unit>(std::to_chars(first, last, q.count(), fmt, precision), last);
+  }
+
+}  // namespace units
+
+#if defined(__cpp_lib_format)
+
+// The format specification applies to the number ("{:.1f}" -> "12.5 km"), the symbol is appended after it.
+template<typename Unit, typename Rep, typename CharT>
+struct std::formatter<units::quantity<Unit, Rep>, CharT> : std::formatter<Rep, CharT> {
+  template<typename FormatContext>
+  auto format(const units::quantity<Unit, Rep>& q, FormatContext& ctx) const
+  {
+    auto out = std::formatter<Rep, CharT>::format(q.count(), ctx);
+    constexpr std::string_view symbol = units::unit_symbol<Unit>;
+    if constexpr(!symbol.empty()) {
+      *out++ = CharT(' ');
+      for(char c : symbol) *out++ = CharT(c);
+    }
+    return out;
+  }
+};
+
+#endif
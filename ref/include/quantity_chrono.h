@@ -0,0 +1,96 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "time.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace units {
+
+  // quantity_conversion<std::chrono::duration>
+
+  // A duration maps onto the time quantity with the same representation and ratio, so conversions between the two
+  // only copy the count and compile to nothing. Between different ratios or representations they follow the
+  // quantity rules: implicit when no precision is lost (e.g. seconds to quantity<millisecond>), explicit otherwise.
+  template<typename Rep, typename Period>
+  struct quantity_conversion<std::chrono::duration<Rep, Period>> {
+    using quantity_type = quantity<unit<dimension_time, typename Period::type>, Rep>;
+
+    static constexpr quantity_type to_quantity(const std::chrono::duration<Rep, Period>& d)
+    {
+      return quantity_type(d.count());
+    }
+
+    static constexpr std::chrono::duration<Rep, Period> from_quantity(const quantity_type& q)
+    {
+      return std::chrono::duration<Rep, Period>(q.count());
+    }
+  };
+
+  // as_duration, as_quantity (the same-ratio counterpart of the argument)
+
+  template<typename Unit, typename Rep, Requires<same_dim<Unit, second>> = true>
+  [[nodiscard]] constexpr std::chrono::duration<Rep, typename Unit::ratio> as_duration(const quantity<Unit, Rep>& q)
+  {
+    return std::chrono::duration<Rep, typename Unit::ratio>(q.count());
+  }
+
+  template<typename Rep, typename Period>
+  [[nodiscard]] constexpr auto as_quantity(const std::chrono::duration<Rep, Period>& d)
+  {
+    return quantity_conversion<std::chrono::duration<Rep, Period>>::to_quantity(d);
+  }
+
+  // sleep_for, wait_for (std::chrono adaptors taking a time quantity)
+
+  template<typename Unit, typename Rep, Requires<same_dim<Unit, second>> = true>
+  void sleep_for(const quantity<Unit, Rep>& q)
+  {
+    std::this_thread::sleep_for(as_duration(q));
+  }
+
+  template<typename Unit, typename Rep, Requires<same_dim<Unit, second>> = true>
+  std::cv_status wait_for(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, const quantity<Unit, Rep>& q)
+  {
+    return cv.wait_for(lock, as_duration(q));
+  }
+
+  template<typename Unit, typename Rep, typename Predicate, Requires<same_dim<Unit, second>> = true>
+  bool wait_for(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, const quantity<Unit, Rep>& q,
+                Predicate pred)
+  {
+    return cv.wait_for(lock, as_duration(q), std::move(pred));
+  }
+
+  // any other waitable with a wait_for(duration) member (std::future, std::shared_future, ...)
+  template<typename Waitable, typename Unit, typename Rep, Requires<same_dim<Unit, second>> = true>
+  auto wait_for(const Waitable& w, const quantity<Unit, Rep>& q) -> decltype(w.wait_for(as_duration(q)))
+  {
+    return w.wait_for(as_duration(q));
+  }
+
+}  // namespace units
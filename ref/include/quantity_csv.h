@@ -0,0 +1,299 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity_charconv.h"
+#include "quantity_file.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace units {
+
+  // csv_header_cell
+
+  // "speed[km/h]" -> {"speed", "km/h"}; the symbol is empty if the cell has no unit
+  struct csv_header_cell {
+    std::string_view name;
+    std::string_view symbol;
+  };
+
+  constexpr csv_header_cell parse_csv_header_cell(std::string_view cell)
+  {
+    auto trim = [](std::string_view s) {
+      while(!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '"')) s.remove_prefix(1);
+      while(!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r' || s.back() == '"')) s.remove_suffix(1);
+      return s;
+    };
+    cell = trim(cell);
+    const std::size_t open = cell.find('[');
+    if(open == std::string_view::npos || cell.back() != ']') return {cell, {}};
+    return {trim(cell.substr(0, open)), trim(cell.substr(open + 1, cell.size() - open - 2))};
+  }
+
+  // csv_column
+
+  // binds a column of the file by its name to the array receiving its values
+  template<typename Unit, typename Rep>
+  struct csv_column {
+    std::string_view name;
+    quantity_array<Unit, Rep>* out;
+
+    csv_column(std::string_view n, quantity_array<Unit, Rep>& o) : name(n), out(&o) {}
+  };
+
+  // csv_options
+
+  struct csv_options {
+    char delimiter = ',';
+    unsigned threads = 0;  // std::thread::hardware_concurrency() if 0
+  };
+
+  namespace detail {
+
+    // csv_sink
+
+    // type-erased destination of one column: parses a field at 'first' into the row 'row' of 'out'
+    struct csv_sink {
+      using parse_fn = const char* (*)(const char* first, const char* last, void* out, std::size_t row, std::errc& ec);
+
+      std::size_t cell;
+      parse_fn parse;
+      void* out;
+      std::size_t value_size;
+    };
+
+    template<typename To, typename From>
+    const char* parse_csv_field(const char* first, const char* last, void* out, std::size_t row, std::errc& ec)
+    {
+      decimal d;
+      const char* p = scan_decimal(first, last, d);
+      if(p == first) {
+        ec = std::errc::invalid_argument;
+        return first;
+      }
+      ec = parse_as<To, From>(d, first, p, p, static_cast<To*>(out)[row]).ec;
+      return p;
+    }
+
+    template<typename To, typename From>
+    void select_csv_parser(csv_sink::parse_fn& parse, std::errc& ec)
+    {
+      if constexpr(same_dim<typename To::unit, From>) {
+        parse = &parse_csv_field<To, From>;
+        ec = std::errc{};
+      }
+      else
+        ec = std::errc::argument_out_of_domain;
+    }
+
+    // the unit of a header is one of the units recognized by from_chars; converted to the unit of 'To' while parsing
+    template<typename To, typename... Units>
+    std::errc select_csv_parser(unit_list<Units...>, std::string_view symbol, csv_sink::parse_fn& parse)
+    {
+      std::errc ec = std::errc::invalid_argument;
+      (void)(((symbol == unit_suffix<Units> || symbol == unit_symbol<Units>) &&
+              (select_csv_parser<To, Units>(parse, ec), true)) || ...);
+      return ec;
+    }
+
+    [[noreturn]] inline void throw_csv_error(std::errc ec, const char* path, std::size_t line, std::string_view what)
+    {
+      throw std::system_error(std::make_error_code(ec),
+                              std::string(path) + ":" + std::to_string(line) + ": " + std::string(what));
+    }
+
+    struct csv_chunk {
+      const char* first;
+      const char* last;
+      std::size_t row = 0;     // index of the first line of the chunk
+      std::size_t rows = 0;    // lines in the chunk, including blank ones
+      std::size_t parsed = 0;  // rows stored from 'row' on, without the blank lines
+      std::errc ec{};
+      std::size_t error_row = 0;
+    };
+
+    // parses the rows of a chunk in a single pass, skipping blank lines; 'sinks' are sorted by their cells
+    inline void parse_csv_chunk(csv_chunk& chunk, const std::vector<csv_sink>& sinks, char delimiter)
+    {
+      const char* p = chunk.first;
+      const char* const last = chunk.last;
+      auto fail = [&](std::size_t line, std::errc ec) {
+        chunk.ec = ec;
+        chunk.error_row = line;
+      };
+      for(std::size_t line = chunk.row; p != last; ++line) {
+        const char* q = p;
+        while(q != last && (*q == ' ' || *q == '\t' || *q == '\r')) ++q;
+        if(q == last) break;
+        if(*q == '\n') {
+          p = q + 1;
+          continue;
+        }
+        const std::size_t row = chunk.row + chunk.parsed++;
+        std::size_t cell = 0;
+        for(const csv_sink& sink : sinks) {
+          for(; cell < sink.cell; ++cell) {
+            while(p != last && *p != delimiter && *p != '\n') ++p;
+            if(p == last || *p == '\n') return fail(line, std::errc::invalid_argument);  // missing field
+            ++p;
+          }
+          while(p != last && (*p == ' ' || *p == '\t')) ++p;
+          std::errc ec{};
+          p = sink.parse(p, last, sink.out, row, ec);
+          while(p != last && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+          if(ec == std::errc{} && p != last && *p != delimiter && *p != '\n') ec = std::errc::invalid_argument;
+          if(ec != std::errc{}) return fail(line, ec);
+        }
+        const void* line_last = std::memchr(p, '\n', static_cast<std::size_t>(last - p));
+        p = line_last != nullptr ? static_cast<const char*>(line_last) + 1 : last;
+      }
+    }
+
+    template<typename Unit, typename Rep>
+    csv_sink make_csv_sink(const char* path, const std::vector<csv_header_cell>& header, const csv_column<Unit, Rep>& c)
+    {
+      using to = quantity<Unit, Rep>;
+      const auto it = std::find_if(header.begin(), header.end(), [&](const csv_header_cell& h) { return h.name == c.name; });
+      if(it == header.end()) throw_csv_error(std::errc::invalid_argument, path, 1, "no column '" + std::string(c.name) + "'");
+      if(it->symbol.empty())
+        throw_csv_error(std::errc::invalid_argument, path, 1, "column '" + std::string(c.name) + "' has no unit");
+      csv_sink sink{static_cast<std::size_t>(it - header.begin()), nullptr, nullptr, sizeof(to)};
+      if(const std::errc ec = select_csv_parser<to>(suffixed_units{}, it->symbol, sink.parse); ec != std::errc{})
+        throw_csv_error(ec, path, 1, "unit '" + std::string(it->symbol) + "' of column '" + std::string(c.name) + "'");
+      return sink;
+    }
+
+  }  // namespace detail
+
+  // read_csv
+
+  // Loads the named columns of a CSV file with a header row of "name[unit]" cells, converting each value from the
+  // unit of its header to the unit of the destination array while parsing. The file is memory-mapped and split at
+  // line boundaries into chunks parsed by 'options.threads' threads straight into the resized destination arrays.
+  // Fields are plain numbers (quoting is not supported); other columns and blank lines are skipped. Errors are
+  // reported with std::system_error carrying the line number: std::errc::invalid_argument for a missing column, a
+  // column bound more than once, an unknown unit or a malformed field, std::errc::argument_out_of_domain for a unit
+  // of a different dimension and std::errc::result_out_of_range for a value that does not fit. Returns the number
+  // of rows.
+  template<typename... Units, typename... Reps>
+  std::size_t read_csv(const char* path, const csv_options& options, csv_column<Units, Reps>... columns)
+  {
+    const detail::mapped_file file(path);
+    const char* const first = reinterpret_cast<const char*>(file.data());
+    const char* const last = first + file.size();
+
+    // header
+    const char* const header_last = std::find(first, last, '\n');
+    std::vector<csv_header_cell> header;
+    for(const char* p = first;;) {
+      const char* const cell_last = std::find(p, header_last, options.delimiter);
+      header.push_back(parse_csv_header_cell(std::string_view(p, static_cast<std::size_t>(cell_last - p))));
+      if(cell_last == header_last) break;
+      p = cell_last + 1;
+    }
+    std::vector<detail::csv_sink> sinks = {detail::make_csv_sink(path, header, columns)...};
+    for(std::size_t i = 0; i < sinks.size(); ++i)
+      for(std::size_t j = 0; j < i; ++j)
+        if(sinks[i].cell == sinks[j].cell)
+          detail::throw_csv_error(std::errc::invalid_argument, path, 1,
+                                  "column '" + std::string(header[sinks[i].cell].name) + "' is bound more than once");
+
+    // chunks split at line boundaries, then sized by their line counts
+    const char* const body = header_last == last ? last : header_last + 1;
+    const unsigned threads = std::max(1u, options.threads != 0 ? options.threads : std::thread::hardware_concurrency());
+    std::vector<detail::csv_chunk> chunks;
+    for(const char* p = body; p != last;) {
+      const char* chunk_last = p + std::min(static_cast<std::size_t>(last - body) / threads + 1,
+                                            static_cast<std::size_t>(last - p));
+      chunk_last = chunk_last == last ? last : std::find(chunk_last, last, '\n');
+      if(chunk_last != last) ++chunk_last;
+      chunks.push_back({p, chunk_last});
+      p = chunk_last;
+    }
+
+    auto for_each_chunk = [&](auto f) {
+      if(chunks.size() <= 1) {
+        for(auto& c : chunks) f(c);
+        return;
+      }
+      std::vector<std::thread> workers;
+      workers.reserve(chunks.size() - 1);
+      try {
+        for(std::size_t i = 1; i < chunks.size(); ++i) workers.emplace_back([&, i] { f(chunks[i]); });
+      }
+      catch(...) {
+        // a thread failed to start: join the running ones before giving up
+        for(auto& w : workers) w.join();
+        throw;
+      }
+      f(chunks.front());
+      for(auto& w : workers) w.join();
+    };
+
+    for_each_chunk([](detail::csv_chunk& c) {
+      c.rows = detail::simd::count(c.first, static_cast<std::size_t>(c.last - c.first), '\n') + (c.last[-1] != '\n');
+    });
+    std::size_t rows = 0;
+    for(auto& c : chunks) {
+      c.row = rows;
+      rows += c.rows;
+    }
+
+    std::size_t i = 0;
+    ((columns.out->resize(rows), sinks[i++].out = columns.out->data()), ...);
+    std::sort(sinks.begin(), sinks.end(),
+              [](const detail::csv_sink& lhs, const detail::csv_sink& rhs) { return lhs.cell < rhs.cell; });
+
+    for_each_chunk([&](detail::csv_chunk& c) { detail::parse_csv_chunk(c, sinks, options.delimiter); });
+    for(const auto& c : chunks)
+      if(c.ec != std::errc{}) detail::throw_csv_error(c.ec, path, c.error_row + 2, "malformed field");
+
+    // rows were sized by lines; with blank lines the rows of every chunk are moved down to follow the previous ones
+    std::size_t parsed = 0;
+    for(const auto& c : chunks) {
+      if(parsed != c.row)
+        for(const detail::csv_sink& sink : sinks) {
+          auto* out = static_cast<char*>(sink.out);
+          std::memmove(out + parsed * sink.value_size, out + c.row * sink.value_size, c.parsed * sink.value_size);
+        }
+      parsed += c.parsed;
+    }
+    if(parsed != rows) (columns.out->resize(parsed), ...);
+    return parsed;
+  }
+
+  template<typename... Units, typename... Reps>
+  std::size_t read_csv(const char* path, csv_column<Units, Reps>... columns)
+  {
+    return read_csv(path, csv_options{}, columns...);
+  }
+
+}  // namespace units
@@ -0,0 +1,210 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity.h"
+#include <functional>
+
+namespace units {
+
+  // Opt-in lazy evaluation of quantity expressions. Wrapping one operand with 'lazy()' makes the whole
+  // expression build a tree that is evaluated in a single pass: every leaf of an additive chain is scaled
+  // exactly once to the common ratio of all leaves instead of rescaling each intermediate result.
+
+  template<typename Q>
+  struct quantity_expr_leaf;
+
+  template<typename T>
+  struct quantity_expr_scalar;
+
+  template<typename Op, typename L, typename R>
+  struct quantity_expr_sum;
+
+  template<typename Op, typename L, typename R>
+  struct quantity_expr_product;
+
+  // is_quantity_expr
+
+  template<typename Q>
+  inline constexpr bool is_quantity_expr<quantity_expr_leaf<Q>> = true;
+
+  template<typename Op, typename L, typename R>
+  inline constexpr bool is_quantity_expr<quantity_expr_sum<Op, L, R>> = true;
+
+  template<typename Op, typename L, typename R>
+  inline constexpr bool is_quantity_expr<quantity_expr_product<Op, L, R>> = true;
+
+  // quantity_expr_leaf
+
+  template<typename Q>
+  struct quantity_expr_leaf {
+    using quantity_type = Q;
+    Q q;
+
+    [[nodiscard]] constexpr quantity_type eval() const { return q; }
+
+    template<typename Target>
+    [[nodiscard]] constexpr typename Target::rep eval_as() const
+    {
+      return quantity_cast<Target>(q).count();
+    }
+
+    [[nodiscard]] constexpr operator quantity_type() const { return eval(); }
+  };
+
+  // quantity_expr_scalar
+
+  template<typename T>
+  struct quantity_expr_scalar {
+    using quantity_type = T;
+    T value;
+
+    [[nodiscard]] constexpr quantity_type eval() const { return value; }
+  };
+
+  // quantity_expr_sum
+
+  template<typename Op, typename L, typename R>
+  struct quantity_expr_sum {
+    using quantity_type = decltype(Op{}(std::declval<typename L::quantity_type>(), std::declval<typename R::quantity_type>()));
+    L lhs;
+    R rhs;
+
+    [[nodiscard]] constexpr quantity_type eval() const { return quantity_type(eval_as<quantity_type>()); }
+
+    // the reps of both operands are already expressed in the final unit so they are combined directly
+    template<typename Target>
+    [[nodiscard]] constexpr typename Target::rep eval_as() const
+    {
+      return Op{}(lhs.template eval_as<Target>(), rhs.template eval_as<Target>());
+    }
+
+    [[nodiscard]] constexpr operator quantity_type() const { return eval(); }
+  };
+
+  // quantity_expr_product
+
+  template<typename Op, typename L, typename R>
+  struct quantity_expr_product {
+    using quantity_type = decltype(Op{}(std::declval<typename L::quantity_type>(), std::declval<typename R::quantity_type>()));
+    L lhs;
+    R rhs;
+
+    // a product changes the dimension so its operands are evaluated on their own
+    [[nodiscard]] constexpr quantity_type eval() const { return Op{}(lhs.eval(), rhs.eval()); }
+
+    template<typename Target>
+    [[nodiscard]] constexpr typename Target::rep eval_as() const
+    {
+      return quantity_cast<Target>(eval()).count();
+    }
+
+    [[nodiscard]] constexpr operator quantity_type() const { return eval(); }
+  };
+
+  // lazy
+
+  template<typename Unit, typename Rep>
+  [[nodiscard]] constexpr quantity_expr_leaf<quantity<Unit, Rep>> lazy(const quantity<Unit, Rep>& q)
+  {
+    return {q};
+  }
+
+  // eval
+
+  template<typename E,
+           Requires<is_quantity_expr<E>> = true>
+  [[nodiscard]] constexpr typename E::quantity_type eval(const E& e)
+  {
+    return e.eval();
+  }
+
+  // expression operators
+
+  namespace detail {
+
+    template<typename T>
+    constexpr auto as_expr(const T& v)
+    {
+      if constexpr(is_quantity_expr<T>)
+        return v;
+      else if constexpr(is_quantity<T>)
+        return quantity_expr_leaf<T>{v};
+      else
+        return quantity_expr_scalar<T>{v};
+    }
+
+    template<typename T>
+    using as_expr_t = decltype(as_expr(std::declval<T>()));
+
+    template<typename T>
+    using expr_quantity_t = typename as_expr_t<T>::quantity_type;
+
+    template<typename Q1, typename Q2>
+    inline constexpr bool expr_addable = false;
+
+    template<typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    inline constexpr bool expr_addable<quantity<Unit1, Rep1>, quantity<Unit2, Rep2>> = same_dim<Unit1, Unit2>;
+
+    template<typename L, typename R>
+    inline constexpr bool expr_operands = is_quantity_expr<L> || is_quantity_expr<R>;
+
+  }  // namespace detail
+
+  template<typename L, typename R,
+           Requires<detail::expr_operands<L, R> &&
+                    detail::expr_addable<detail::expr_quantity_t<L>, detail::expr_quantity_t<R>>> = true>
+  [[nodiscard]] constexpr auto operator+(const L& lhs, const R& rhs)
+  {
+    using ret = quantity_expr_sum<std::plus<>, detail::as_expr_t<L>, detail::as_expr_t<R>>;
+    return ret{detail::as_expr(lhs), detail::as_expr(rhs)};
+  }
+
+  template<typename L, typename R,
+           Requires<detail::expr_operands<L, R> &&
+                    detail::expr_addable<detail::expr_quantity_t<L>, detail::expr_quantity_t<R>>> = true>
+  [[nodiscard]] constexpr auto operator-(const L& lhs, const R& rhs)
+  {
+    using ret = quantity_expr_sum<std::minus<>, detail::as_expr_t<L>, detail::as_expr_t<R>>;
+    return ret{detail::as_expr(lhs), detail::as_expr(rhs)};
+  }
+
+  template<typename L, typename R,
+           Requires<detail::expr_operands<L, R>> = true,
+           typename Q = decltype(std::declval<detail::expr_quantity_t<L>>() * std::declval<detail::expr_quantity_t<R>>())>
+  [[nodiscard]] constexpr auto operator*(const L& lhs, const R& rhs)
+  {
+    using ret = quantity_expr_product<std::multiplies<>, detail::as_expr_t<L>, detail::as_expr_t<R>>;
+    return ret{detail::as_expr(lhs), detail::as_expr(rhs)};
+  }
+
+  template<typename L, typename R,
+           Requires<detail::expr_operands<L, R>> = true,
+           typename Q = decltype(std::declval<detail::expr_quantity_t<L>>() / std::declval<detail::expr_quantity_t<R>>())>
+  [[nodiscard]] constexpr auto operator/(const L& lhs, const R& rhs)
+  {
+    using ret = quantity_expr_product<std::divides<>, detail::as_expr_t<L>, detail::as_expr_t<R>>;
+    return ret{detail::as_expr(lhs), detail::as_expr(rhs)};
+  }
+
+}  // namespace units
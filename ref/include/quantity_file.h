@@ -0,0 +1,514 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity_array.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define UNITS_COLUMN_MMAP 1
+#else
+#define UNITS_COLUMN_MMAP 0
+#endif
+
+namespace units {
+
+  // column_rep
+
+  enum class column_rep : std::uint8_t { int32 = 1, int64, uint32, uint64, float32, float64 };
+
+  namespace detail {
+
+    template<typename Rep>
+    constexpr column_rep column_rep_of()
+    {
+      static_assert(std::is_arithmetic_v<Rep> && !std::is_same_v<Rep, bool> && (sizeof(Rep) == 4 || sizeof(Rep) == 8),
+                    "a column stores 32- or 64-bit integral or floating-point representations");
+      if constexpr(std::is_floating_point_v<Rep>) {
+        static_assert(std::numeric_limits<Rep>::is_iec559, "floating-point representations should be IEEE 754");
+        return sizeof(Rep) == 4 ? column_rep::float32 : column_rep::float64;
+      }
+      else if constexpr(std::is_signed_v<Rep>)
+        return sizeof(Rep) == 4 ? column_rep::int32 : column_rep::int64;
+      else
+        return sizeof(Rep) == 4 ? column_rep::uint32 : column_rep::uint64;
+    }
+
+  }  // namespace detail
+
+  // column_header
+
+  // The file starts with this 128-byte header followed by 'count' values of the representation in the native byte
+  // order. The unit is stored as the exponents of its dimension (base dimension id and exponent, sorted by the id)
+  // and its ratio, so a file can only be read as a quantity of the same dimension.
+  struct column_header {
+    static constexpr char file_magic[8] = {'U', 'N', 'I', 'T', 'C', 'O', 'L', '\0'};
+    static constexpr std::uint32_t current_version = 1;
+    static constexpr std::uint32_t native_byte_order = 0x01020304;
+    static constexpr std::size_t max_exponents = 8;
+
+    struct exponent {
+      std::int16_t id;
+      std::int16_t value;
+    };
+
+    char magic[8] = {};
+    std::uint32_t version = current_version;
+    std::uint32_t byte_order = native_byte_order;
+    std::uint32_t header_size = 128;
+    column_rep rep = {};
+    std::uint8_t rep_size = 0;
+    std::uint8_t exponent_count = 0;
+    std::uint8_t reserved0 = 0;
+    std::int64_t num = 1;
+    std::int64_t den = 1;
+    std::uint64_t count = 0;
+    exponent exponents[max_exponents] = {};
+    std::uint8_t reserved1[48] = {};
+  };
+
+  static_assert(sizeof(column_header) == 128 && std::is_trivially_copyable_v<column_header>);
+
+  namespace detail {
+
+    template<typename Dimension>
+    struct column_exponents;
+
+    template<typename... Es>
+    struct column_exponents<dimension<Es...>> {
+      static_assert(sizeof...(Es) <= column_header::max_exponents, "too many base dimensions for a column header");
+      static_assert(((Es::dimension::value >= 0 && Es::dimension::value <= std::numeric_limits<std::int16_t>::max()) &&
+                     ...),
+                    "base dimension ids of a column should fit in 16 bits");
+
+      static constexpr void fill(column_header& h)
+      {
+        h.exponent_count = sizeof...(Es);
+        std::size_t i = 0;
+        ((h.exponents[i++] = {static_cast<std::int16_t>(Es::dimension::value), static_cast<std::int16_t>(Es::value)}),
+         ...);
+      }
+    };
+
+    constexpr bool same_dimension(const column_header& lhs, const column_header& rhs)
+    {
+      if(lhs.exponent_count != rhs.exponent_count) return false;
+      for(std::size_t i = 0; i < lhs.exponent_count; ++i)
+        if(lhs.exponents[i].id != rhs.exponents[i].id || lhs.exponents[i].value != rhs.exponents[i].value) return false;
+      return true;
+    }
+
+  }  // namespace detail
+
+  // make_column_header
+
+  template<typename Unit, typename Rep>
+  constexpr column_header make_column_header(std::uint64_t count = 0)
+  {
+    column_header h;
+    for(std::size_t i = 0; i < sizeof(h.magic); ++i) h.magic[i] = column_header::file_magic[i];
+    h.rep = detail::column_rep_of<Rep>();
+    h.rep_size = sizeof(Rep);
+    h.num = Unit::ratio::num;
+    h.den = Unit::ratio::den;
+    h.count = count;
+    detail::column_exponents<typename Unit::dimension>::fill(h);
+    return h;
+  }
+
+  // Checks a header read from a file against the header of the requested quantity:
+  //  - std::errc::invalid_argument         not a column file, an unsupported version or a different byte order
+  //  - std::errc::argument_out_of_domain   a different dimension than requested
+  constexpr std::errc check_column_header(const column_header& stored, const column_header& requested)
+  {
+    for(std::size_t i = 0; i < sizeof(stored.magic); ++i)
+      if(stored.magic[i] != column_header::file_magic[i]) return std::errc::invalid_argument;
+    if(stored.version != column_header::current_version || stored.byte_order != column_header::native_byte_order ||
+       stored.header_size != sizeof(column_header) || stored.num <= 0 || stored.den <= 0)
+      return std::errc::invalid_argument;
+    if(stored.rep < column_rep::int32 || stored.rep > column_rep::float64 ||
+       stored.rep_size != (stored.rep == column_rep::int64 || stored.rep == column_rep::uint64 ||
+                                   stored.rep == column_rep::float64 ? 8 : 4))
+      return std::errc::invalid_argument;
+    if(!detail::same_dimension(stored, requested)) return std::errc::argument_out_of_domain;
+    return std::errc();
+  }
+
+  namespace detail {
+
+    [[noreturn]] inline void throw_column_error(std::errc ec, const char* what)
+    {
+      throw std::system_error(std::make_error_code(ec), what);
+    }
+
+    [[noreturn]] inline void throw_errno(const char* what) { throw std::system_error(errno, std::generic_category(), what); }
+
+    // mapped_file
+
+    // read-only view of a whole file, memory-mapped where available
+    class mapped_file {
+      const std::byte* data_ = nullptr;
+      std::size_t size_ = 0;
+
+      void release() noexcept
+      {
+        if(data_ == nullptr) return;
+#if UNITS_COLUMN_MMAP
+        ::munmap(const_cast<std::byte*>(data_), size_);
+#else
+        ::operator delete(const_cast<std::byte*>(data_), std::align_val_t(64));
+#endif
+        data_ = nullptr;
+      }
+
+    public:
+      mapped_file() = default;
+
+      explicit mapped_file(const char* path)
+      {
+#if UNITS_COLUMN_MMAP
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if(fd < 0) throw_errno(path);
+        struct stat st;
+        if(::fstat(fd, &st) != 0) {
+          const int err = errno;
+          ::close(fd);
+          throw std::system_error(err, std::generic_category(), path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if(size_ != 0) {
+          void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+          const int err = errno;
+          ::close(fd);
+          if(p == MAP_FAILED) throw std::system_error(err, std::generic_category(), path);
+          ::madvise(p, size_, MADV_SEQUENTIAL);
+          data_ = static_cast<const std::byte*>(p);
+        }
+        else
+          ::close(fd);
+#else
+        std::FILE* f = std::fopen(path, "rb");
+        if(f == nullptr) throw_errno(path);
+        std::fseek(f, 0, SEEK_END);
+        const long size = std::ftell(f);
+        std::fseek(f, 0, SEEK_SET);
+        size_ = size > 0 ? static_cast<std::size_t>(size) : 0;
+        auto* p = static_cast<std::byte*>(::operator new(size_ + 1, std::align_val_t(64)));
+        const bool ok = std::fread(p, 1, size_, f) == size_;
+        std::fclose(f);
+        data_ = p;
+        if(!ok) {
+          release();
+          throw_column_error(std::errc::io_error, path);
+        }
+#endif
+      }
+
+      mapped_file(mapped_file&& other) noexcept
+          : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+      {
+      }
+      mapped_file& operator=(mapped_file&& other) noexcept
+      {
+        if(this != &other) {
+          release();
+          data_ = std::exchange(other.data_, nullptr);
+          size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+      }
+      ~mapped_file() { release(); }
+
+      [[nodiscard]] const std::byte* data() const noexcept { return data_; }
+      [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    };
+
+    // column_conversion
+
+#if defined(__SIZEOF_INT128__)
+    using column_wide = int128;
+    using column_uwide = uint128;
+#else
+    using column_wide = std::intmax_t;
+    using column_uwide = std::uintmax_t;
+#endif
+
+    // stored ratio / requested ratio, reduced
+    struct column_ratio {
+      std::int64_t num;
+      std::int64_t den;
+    };
+
+    constexpr column_ratio make_column_ratio(std::int64_t num1, std::int64_t den1, std::int64_t num2, std::int64_t den2)
+    {
+      // a file may store an equal but unreduced ratio (e.g. 2/2000 for a millisecond)
+      const std::int64_t r1 = std::gcd(num1, den1);
+      const std::int64_t r2 = std::gcd(num2, den2);
+      num1 /= r1;
+      den1 /= r1;
+      num2 /= r2;
+      den2 /= r2;
+      const std::int64_t g1 = std::gcd(num1, num2);
+      const std::int64_t g2 = std::gcd(den1, den2);
+      const auto num = static_cast<column_wide>(num1 / g1) * (den2 / g2);
+      const auto den = static_cast<column_wide>(den1 / g2) * (num2 / g1);
+      constexpr auto max = std::numeric_limits<std::int64_t>::max();
+      if(num > max || den > max) throw_column_error(std::errc::result_out_of_range, "column ratio");
+      return {static_cast<std::int64_t>(num), static_cast<std::int64_t>(den)};
+    }
+
+    // integral values that do not fit in an integral 'To' are rejected (std::errc::value_too_large) rather than
+    // wrapped around
+    template<typename To>
+    To column_narrow(column_wide v)
+    {
+      constexpr auto max = static_cast<column_uwide>(std::numeric_limits<To>::max());
+      const bool fits =
+          v >= 0 ? static_cast<column_uwide>(v) <= max : std::is_signed_v<To> && v >= std::numeric_limits<To>::min();
+      if(!fits) throw_column_error(std::errc::value_too_large, "column value");
+      return static_cast<To>(v);
+    }
+
+    // Converts a stored value to 'To' like static_cast, but integral and floating-point values out of the range of an
+    // integral 'To' are rejected (std::errc::value_too_large) rather than wrapped around or converted with undefined
+    // behaviour.
+    template<typename To, typename From>
+    To column_cast(From v)
+    {
+      if constexpr(std::is_integral_v<From> && std::is_integral_v<To>) {
+        if constexpr(std::is_same_v<From, To>)
+          return v;
+        else
+          return column_narrow<To>(static_cast<column_wide>(v));
+      }
+      if constexpr(std::is_floating_point_v<From> && std::is_integral_v<To>) {
+        constexpr long double upper = static_cast<long double>(std::numeric_limits<To>::max() / 2 + 1) * 2;
+        constexpr long double lower = static_cast<long double>(std::numeric_limits<To>::min());
+        const auto lv = static_cast<long double>(v);
+        if(!(lv < upper && (std::is_signed_v<To> ? lv >= lower : lv > -1)))
+          throw_column_error(std::errc::value_too_large, "column value");
+      }
+      return static_cast<To>(v);
+    }
+
+    // integral values are scaled exactly and truncated like quantity_cast, floating-point ones rounded once
+    template<typename From, typename To>
+    void convert_column_reps(const From* in, To* out, std::size_t n, column_ratio r)
+    {
+      if(r.num == 1 && r.den == 1)
+        for(std::size_t i = 0; i < n; ++i) out[i] = column_cast<To>(in[i]);
+      else if constexpr(std::is_integral_v<From> && std::is_integral_v<To>) {
+        if(r.den == 1)
+          for(std::size_t i = 0; i < n; ++i) out[i] = column_narrow<To>(column_wide(in[i]) * r.num);
+        else
+          for(std::size_t i = 0; i < n; ++i) out[i] = column_narrow<To>(column_wide(in[i]) * r.num / r.den);
+      }
+      else {
+        const long double num = static_cast<long double>(r.num);
+        const long double den = static_cast<long double>(r.den);
+        for(std::size_t i = 0; i < n; ++i) out[i] = column_cast<To>(static_cast<long double>(in[i]) * num / den);
+      }
+    }
+
+    template<typename To>
+    void convert_column(column_rep rep, const std::byte* in, To* out, std::size_t n, column_ratio r)
+    {
+      auto convert = [&](auto tag) {
+        using from = decltype(tag);
+        static_assert(alignof(from) <= 64);
+        convert_column_reps(reinterpret_cast<const from*>(in), out, n, r);  // aligned: data starts at 128 bytes
+      };
+      switch(rep) {
+        case column_rep::int32: convert(std::int32_t()); break;
+        case column_rep::int64: convert(std::int64_t()); break;
+        case column_rep::uint32: convert(std::uint32_t()); break;
+        case column_rep::uint64: convert(std::uint64_t()); break;
+        case column_rep::float32: convert(float()); break;
+        case column_rep::float64: convert(double()); break;
+      }
+    }
+
+  }  // namespace detail
+
+  // column_reader
+
+  // Maps a column file and views it as quantities of 'Unit' and 'Rep'. Opening fails with std::system_error for an
+  // I/O error, a malformed header (std::errc::invalid_argument) or a different dimension than the one of 'Unit'
+  // (std::errc::argument_out_of_domain). When the stored unit and representation are the requested ones the values
+  // are available in place through span(), otherwise read() and for_each_batch() convert them in batches.
+  template<typename Unit, typename Rep>
+  class column_reader {
+  public:
+    using value_type = quantity<Unit, Rep>;
+
+  private:
+    detail::mapped_file file_;
+    column_header header_;
+    detail::column_ratio ratio_ = {1, 1};
+
+    [[nodiscard]] const std::byte* values() const noexcept { return file_.data() + sizeof(column_header); }
+
+  public:
+    explicit column_reader(const char* path) : file_(path)
+    {
+      if(file_.size() < sizeof(column_header)) detail::throw_column_error(std::errc::invalid_argument, path);
+      std::memcpy(&header_, file_.data(), sizeof(column_header));
+      if(const std::errc ec = check_column_header(header_, make_column_header<Unit, Rep>()); ec != std::errc())
+        detail::throw_column_error(ec, path);
+      if(header_.count > (file_.size() - sizeof(column_header)) / header_.rep_size)
+        detail::throw_column_error(std::errc::invalid_argument, path);
+      ratio_ = detail::make_column_ratio(header_.num, header_.den, Unit::ratio::num, Unit::ratio::den);
+    }
+
+    [[nodiscard]] const column_header& header() const noexcept { return header_; }
+    [[nodiscard]] std::size_t size() const noexcept { return static_cast<std::size_t>(header_.count); }
+
+    // true if the values are stored exactly as 'value_type'
+    [[nodiscard]] bool is_exact() const noexcept
+    {
+      return header_.rep == detail::column_rep_of<Rep>() && ratio_.num == 1 && ratio_.den == 1;
+    }
+
+    // zero-copy view of the mapped values; requires is_exact()
+    [[nodiscard]] quantity_span<const value_type> span() const
+    {
+      static_assert(std::is_standard_layout_v<value_type> && sizeof(value_type) == sizeof(Rep));
+      if(!is_exact()) detail::throw_column_error(std::errc::invalid_argument, "column is stored in a different unit");
+      return {reinterpret_cast<const value_type*>(values()), size()};
+    }
+
+    // converts (or copies) up to out.size() values starting at 'offset'; returns the number of values written. A value
+    // out of the range of 'Rep' fails with std::errc::value_too_large.
+    std::size_t read(std::size_t offset, quantity_span<value_type> out) const
+    {
+      if(offset >= size()) return 0;
+      const std::size_t n = std::min(out.size(), size() - offset);
+      detail::convert_column(header_.rep, values() + offset * header_.rep_size, detail::rep_data(out.data()), n, ratio_);
+      return n;
+    }
+
+    // calls 'f' with consecutive quantity_span<const value_type> chunks covering the whole column, in place when
+    // the column is exact and converted through a buffer of 'batch' values otherwise; a 'batch' of 0 fails with
+    // std::errc::invalid_argument
+    template<typename F>
+    void for_each_batch(F f, std::size_t batch = 4096) const
+    {
+      if(batch == 0) detail::throw_column_error(std::errc::invalid_argument, "column batch size");
+      if(is_exact()) {
+        const auto all = span();
+        for(std::size_t offset = 0; offset < all.size(); offset += batch)
+          f(all.subspan(offset, std::min(batch, all.size() - offset)));
+        return;
+      }
+      quantity_array<Unit, Rep> buffer(batch);
+      for(std::size_t offset = 0; offset < size(); offset += batch)
+        f(quantity_span<const value_type>(buffer.data(), read(offset, buffer)));
+    }
+  };
+
+  // column_writer
+
+  // Appends quantities to a new column file; the count in the header is updated by close() (or the destructor).
+  // Closing twice is a no-op, appending to a closed writer fails with std::errc::bad_file_descriptor.
+  template<typename Unit, typename Rep>
+  class column_writer {
+  public:
+    using value_type = quantity<Unit, Rep>;
+
+  private:
+    std::FILE* file_ = nullptr;
+    std::uint64_t count_ = 0;
+
+    void write(const void* data, std::size_t size)
+    {
+      if(std::fwrite(data, 1, size, file_) != size) detail::throw_column_error(std::errc::io_error, "column write");
+    }
+
+  public:
+    explicit column_writer(const char* path) : file_(std::fopen(path, "wb"))
+    {
+      if(file_ == nullptr) detail::throw_errno(path);
+      const column_header h = make_column_header<Unit, Rep>();
+      write(&h, sizeof(h));
+    }
+
+    column_writer(const column_writer&) = delete;
+    column_writer& operator=(const column_writer&) = delete;
+
+    ~column_writer()
+    {
+      if(file_ == nullptr) return;
+      try {
+        close();
+      }
+      catch(...) {
+      }
+    }
+
+    [[nodiscard]] std::uint64_t size() const noexcept { return count_; }
+
+    void append(quantity_span<const value_type> values)
+    {
+      if(file_ == nullptr) detail::throw_column_error(std::errc::bad_file_descriptor, "column writer is closed");
+      write(values.data(), values.size() * sizeof(value_type));
+      count_ += values.size();
+    }
+
+    void append(const value_type& q) { append(quantity_span<const value_type>(&q, 1)); }
+
+    void close()
+    {
+      if(file_ == nullptr) return;
+      std::FILE* f = std::exchange(file_, nullptr);
+      const column_header h = make_column_header<Unit, Rep>(count_);
+      const bool ok = std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&h, 1, sizeof(h), f) == sizeof(h);
+      if(std::fclose(f) != 0 || !ok) detail::throw_column_error(std::errc::io_error, "column close");
+    }
+  };
+
+  // write_column
+
+  template<typename Q>
+  void write_column(const char* path, quantity_span<const Q> values)
+  {
+    column_writer<typename Q::unit, typename Q::rep> writer(path);
+    writer.append(values);
+    writer.close();
+  }
+
+}  // namespace units
+
+#undef UNITS_COLUMN_MMAP
@@ -0,0 +1,286 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity_array.h"
+#include "quantity_file.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace units {
+
+  // ring_producers
+
+  enum class ring_producers : std::uint8_t { single = 1, multiple };
+
+  namespace detail {
+
+    // the counters written by different sides live on separate pairs of cache lines (the adjacent-line prefetcher
+    // pulls in lines in pairs)
+    inline constexpr std::size_t ring_padding = 128;
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "ring counters must be address-free atomics");
+
+    struct ring_control {
+      column_header unit;
+      std::uint64_t capacity = 0;
+      ring_producers producers = ring_producers::single;
+      std::atomic<std::uint32_t> ready{0};
+      alignas(ring_padding) std::atomic<std::uint64_t> head{0};  // written by the consumer
+      alignas(ring_padding) std::atomic<std::uint64_t> tail{0};  // written by the producers
+    };
+
+    template<typename Q>
+    struct ring_sequenced_slot {
+      std::atomic<std::uint64_t> sequence{0};  // position + 1 once the value is published
+      Q value;
+    };
+
+    template<typename Q, ring_producers Producers>
+    using ring_slot = std::conditional_t<Producers == ring_producers::single, Q, ring_sequenced_slot<Q>>;
+
+    template<typename Q, ring_producers Producers>
+    constexpr std::size_t ring_bytes(std::size_t capacity)
+    {
+      return (sizeof(ring_control) + ring_padding - 1) / ring_padding * ring_padding +
+             capacity * sizeof(ring_slot<Q, Producers>);
+    }
+
+  }  // namespace detail
+
+  // shm_ring
+
+  // A lock-free ring of quantities in POSIX shared memory for a single consumer and one or many producers. The
+  // creating side records the unit of 'Q' in the shared control block and every attaching side checks it: attach()
+  // throws std::system_error with std::errc::argument_out_of_domain for a different dimension and with
+  // std::errc::invalid_argument for a different ratio, rep, producer mode or a malformed segment, or
+  // std::errc::resource_unavailable_try_again while the creator is still initializing it. Values are copied in and
+  // out in batches; the producers and the consumer only touch each other's counter when their cached copy runs out.
+  template<typename Q, ring_producers Producers = ring_producers::single>
+  class shm_ring {
+    static_assert(is_quantity<Q> && std::is_trivially_copyable_v<Q>, "shm_ring stores units::quantity values");
+
+  public:
+    using value_type = Q;
+    using slot = detail::ring_slot<Q, Producers>;
+
+  private:
+    detail::ring_control* control_ = nullptr;
+    slot* slots_ = nullptr;
+    std::size_t bytes_ = 0;
+    std::uint64_t mask_ = 0;
+    std::uint64_t cached_head_ = 0;  // producer side copy of the consumer counter (single producer only)
+    std::uint64_t cached_tail_ = 0;  // consumer side copy of the producer counter (single producer only)
+
+    shm_ring(void* p, std::size_t bytes)
+        : control_(static_cast<detail::ring_control*>(p)),
+          slots_(reinterpret_cast<slot*>(static_cast<std::byte*>(p) + detail::ring_bytes<Q, Producers>(0))),
+          bytes_(bytes),
+          mask_(control_->capacity - 1)
+    {
+    }
+
+    static std::pair<void*, std::size_t> map(int fd, const char* name, std::size_t bytes)
+    {
+      void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      const int err = errno;
+      ::close(fd);
+      if(p == MAP_FAILED) throw std::system_error(err, std::generic_category(), name);
+      return {p, bytes};
+    }
+
+  public:
+    shm_ring(const shm_ring&) = delete;
+    shm_ring& operator=(const shm_ring&) = delete;
+    shm_ring(shm_ring&& other) noexcept
+        : control_(std::exchange(other.control_, nullptr)),
+          slots_(other.slots_),
+          bytes_(other.bytes_),
+          mask_(other.mask_),
+          cached_head_(other.cached_head_),
+          cached_tail_(other.cached_tail_)
+    {
+    }
+    shm_ring& operator=(shm_ring&& other) noexcept
+    {
+      if(this != &other) {
+        if(control_ != nullptr) ::munmap(control_, bytes_);
+        control_ = std::exchange(other.control_, nullptr);
+        slots_ = other.slots_;
+        bytes_ = other.bytes_;
+        mask_ = other.mask_;
+        cached_head_ = other.cached_head_;
+        cached_tail_ = other.cached_tail_;
+      }
+      return *this;
+    }
+    ~shm_ring()
+    {
+      if(control_ != nullptr) ::munmap(control_, bytes_);
+    }
+
+    // creates a new segment holding 'capacity' (rounded up to a power of 2) values; fails if 'name' exists
+    [[nodiscard]] static shm_ring create(const char* name, std::size_t capacity)
+    {
+      std::size_t pow2 = 1;
+      while(pow2 < capacity) pow2 *= 2;
+      const std::size_t bytes = detail::ring_bytes<Q, Producers>(pow2);
+      const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+      if(fd < 0) detail::throw_errno(name);
+      if(::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        const int err = errno;
+        ::close(fd);
+        ::shm_unlink(name);
+        throw std::system_error(err, std::generic_category(), name);
+      }
+      void* p = nullptr;
+      try {
+        p = map(fd, name, bytes).first;
+      }
+      catch(...) {
+        ::shm_unlink(name);
+        throw;
+      }
+      auto* control = new(p) detail::ring_control;
+      control->unit = make_column_header<typename Q::unit, typename Q::rep>(pow2);
+      control->capacity = pow2;
+      control->producers = Producers;
+      shm_ring ring(p, bytes);
+      if constexpr(Producers == ring_producers::multiple)
+        for(std::size_t i = 0; i < pow2; ++i) new(&ring.slots_[i]) slot;
+      control->ready.store(1, std::memory_order_release);
+      return ring;
+    }
+
+    // attaches to a segment created by another process (or thread) and checks its unit
+    [[nodiscard]] static shm_ring attach(const char* name)
+    {
+      const int fd = ::shm_open(name, O_RDWR, 0);
+      if(fd < 0) detail::throw_errno(name);
+      struct stat st;
+      if(::fstat(fd, &st) != 0) {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), name);
+      }
+      const auto size = static_cast<std::size_t>(st.st_size);
+      if(size < sizeof(detail::ring_control)) {
+        ::close(fd);
+        detail::throw_column_error(std::errc::resource_unavailable_try_again, name);
+      }
+      shm_ring ring(map(fd, name, size).first, size);
+      const detail::ring_control& c = *ring.control_;
+      if(c.ready.load(std::memory_order_acquire) != 1)
+        detail::throw_column_error(std::errc::resource_unavailable_try_again, name);
+      const column_header expected = make_column_header<typename Q::unit, typename Q::rep>(c.unit.count);
+      if(const std::errc ec = check_column_header(c.unit, expected); ec != std::errc())
+        detail::throw_column_error(ec, name);
+      if(c.unit.rep != expected.rep || c.unit.num != expected.num || c.unit.den != expected.den ||
+         c.producers != Producers || c.capacity == 0 || (c.capacity & (c.capacity - 1)) != 0 ||
+         size < detail::ring_bytes<Q, Producers>(c.capacity))
+        detail::throw_column_error(std::errc::invalid_argument, name);
+      return ring;
+    }
+
+    static void remove(const char* name) noexcept { ::shm_unlink(name); }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return static_cast<std::size_t>(control_->capacity); }
+
+    // enqueues as many of the values as fit; returns their number
+    std::size_t try_push(quantity_span<const Q> values)
+    {
+      detail::ring_control& c = *control_;
+      std::uint64_t pos = c.tail.load(std::memory_order_relaxed);
+      std::size_t n = 0;
+      if constexpr(Producers == ring_producers::single) {
+        if(pos - cached_head_ + values.size() > c.capacity) cached_head_ = c.head.load(std::memory_order_acquire);
+        n = std::min<std::size_t>(values.size(), static_cast<std::size_t>(c.capacity - (pos - cached_head_)));
+        const std::size_t first = static_cast<std::size_t>(pos & mask_);
+        const std::size_t split = std::min(n, capacity() - first);
+        std::memcpy(slots_ + first, values.data(), split * sizeof(Q));
+        std::memcpy(slots_, values.data() + split, (n - split) * sizeof(Q));
+        c.tail.store(pos + n, std::memory_order_release);
+      }
+      else {
+        do {
+          const std::uint64_t head = c.head.load(std::memory_order_acquire);
+          n = std::min<std::size_t>(values.size(), static_cast<std::size_t>(c.capacity - (pos - head)));
+          if(n == 0) return 0;
+        } while(!c.tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed));
+        for(std::size_t i = 0; i < n; ++i) {
+          slot& s = slots_[(pos + i) & mask_];
+          s.value = values[i];
+          s.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+      }
+      return n;
+    }
+
+    bool try_push(const Q& q) { return try_push(quantity_span<const Q>(&q, 1)) == 1; }
+
+    // dequeues up to out.size() values; returns their number
+    std::size_t try_pop(quantity_span<Q> out)
+    {
+      detail::ring_control& c = *control_;
+      const std::uint64_t pos = c.head.load(std::memory_order_relaxed);
+      std::size_t n = 0;
+      if constexpr(Producers == ring_producers::single) {
+        if(cached_tail_ - pos < out.size()) cached_tail_ = c.tail.load(std::memory_order_acquire);
+        n = std::min<std::size_t>(out.size(), static_cast<std::size_t>(cached_tail_ - pos));
+        const std::size_t first = static_cast<std::size_t>(pos & mask_);
+        const std::size_t split = std::min(n, capacity() - first);
+        std::memcpy(out.data(), slots_ + first, split * sizeof(Q));
+        std::memcpy(out.data() + split, slots_, (n - split) * sizeof(Q));
+      }
+      else {
+        // published values are contiguous up to the first slot still being written by a producer
+        for(; n < out.size(); ++n) {
+          const slot& s = slots_[(pos + n) & mask_];
+          if(s.sequence.load(std::memory_order_acquire) != pos + n + 1) break;
+          out[n] = s.value;
+        }
+      }
+      if(n != 0) c.head.store(pos + n, std::memory_order_release);
+      return n;
+    }
+
+    bool try_pop(Q& q) { return try_pop(quantity_span<Q>(&q, 1)) == 1; }
+  };
+
+  template<typename Q>
+  using mpsc_shm_ring = shm_ring<Q, ring_producers::multiple>;
+
+}  // namespace units
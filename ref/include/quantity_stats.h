@@ -0,0 +1,160 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity_algorithm.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace units {
+
+  namespace detail {
+
+    // Newton's iteration from above; it decreases monotonically and stops at the correctly rounded root (or one ulp
+    // above it). <cmath> is not used as it brings ::exp into scope next to units::exp.
+    template<typename T>
+    constexpr T sqrt(T x)
+    {
+      if(x == 0 || x > std::numeric_limits<T>::max()) return x;
+      if(!(x > 0)) return std::numeric_limits<T>::quiet_NaN();
+      T r = x > 1 ? x : T(1);
+      for(;;) {
+        const T next = (r + x / r) / 2;
+        if(!(next < r)) return r;
+        r = next;
+      }
+    }
+
+  }  // namespace detail
+
+  // quantity_stats
+
+  // Count, minimum, maximum, mean and variance of a stream of quantities in O(1) memory. Single values are added with
+  // Welford's update and batches with a two-pass (sum, then squared deviations) kernel over cache-sized blocks that the
+  // compiler vectorizes; batches and independently filled instances (e.g. one per thread) are combined with Chan's
+  // formula, so merging is associative and the order of merges does not matter beyond rounding. The variance is a
+  // quantity of the squared unit. min() and max() are only meaningful when count() != 0.
+  template<typename Unit, typename Rep = double>
+  class quantity_stats {
+  public:
+    using value_type = quantity<Unit, Rep>;
+    using real = std::common_type_t<Rep, double>;
+    using mean_type = quantity<Unit, real>;
+    using variance_type = quantity<product_unit<Unit, Unit>, real>;
+
+  private:
+    // elements per batch block; both passes over a block run from L1
+    static constexpr std::size_t block = 2048;
+
+    std::uint64_t count_ = 0;
+    real mean_ = 0;
+    real m2_ = 0;  // sum of squared deviations from the mean
+    Rep min_ = quantity_values<Rep>::max();
+    Rep max_ = quantity_values<Rep>::min();
+
+    constexpr void combine(std::uint64_t count, real mean, real m2, Rep min, Rep max)
+    {
+      if(count == 0) return;
+      const std::uint64_t total = count_ + count;
+      const real delta = mean - mean_;
+      const real share = real(count) / real(total);
+      mean_ += delta * share;
+      m2_ += m2 + delta * delta * real(count_) * share;
+      count_ = total;
+      min_ = std::min(min_, min);
+      max_ = std::max(max_, max);
+    }
+
+  public:
+    constexpr quantity_stats() = default;
+
+    constexpr void update(const value_type& q)
+    {
+      const real x = real(q.count());
+      ++count_;
+      const real delta = x - mean_;
+      mean_ += delta / real(count_);
+      m2_ += delta * (x - mean_);
+      min_ = std::min(min_, q.count());
+      max_ = std::max(max_, q.count());
+    }
+
+    constexpr void update(quantity_span<const value_type> values)
+    {
+      const value_type* p = values.data();
+      for(std::size_t first = 0; first < values.size(); first += block) {
+        const std::size_t last = std::min(values.size(), first + block);
+        Rep lo = p[first].count();
+        Rep hi = lo;
+        for(std::size_t i = first; i < last; ++i) {
+          lo = p[i].count() < lo ? p[i].count() : lo;
+          hi = p[i].count() > hi ? p[i].count() : hi;
+        }
+        const real n = real(last - first);
+        const real sum = detail::sum_range<true, real>(first, last, [p](std::size_t i) { return real(p[i].count()); });
+        const real mean = sum / n;
+        const real m2 = detail::sum_range<true, real>(first, last, [p, mean](std::size_t i) {
+          const real d = real(p[i].count()) - mean;
+          return d * d;
+        });
+        combine(last - first, mean, m2, lo, hi);
+      }
+    }
+
+    constexpr quantity_stats& merge(const quantity_stats& other)
+    {
+      combine(other.count_, other.mean_, other.m2_, other.min_, other.max_);
+      return *this;
+    }
+
+    constexpr quantity_stats& operator+=(const quantity_stats& other) { return merge(other); }
+
+    [[nodiscard]] friend constexpr quantity_stats operator+(quantity_stats lhs, const quantity_stats& rhs)
+    {
+      return lhs.merge(rhs);
+    }
+
+    [[nodiscard]] constexpr std::uint64_t count() const noexcept { return count_; }
+    [[nodiscard]] constexpr value_type min() const noexcept { return value_type(min_); }
+    [[nodiscard]] constexpr value_type max() const noexcept { return value_type(max_); }
+    [[nodiscard]] constexpr mean_type mean() const noexcept { return mean_type(mean_); }
+
+    // population variance
+    [[nodiscard]] constexpr variance_type variance() const noexcept
+    {
+      return variance_type(count_ == 0 ? real(0) : m2_ / real(count_));
+    }
+
+    // unbiased (Bessel-corrected) variance of a sample
+    [[nodiscard]] constexpr variance_type sample_variance() const noexcept
+    {
+      return variance_type(count_ < 2 ? real(0) : m2_ / real(count_ - 1));
+    }
+
+    [[nodiscard]] constexpr mean_type stddev() const noexcept { return mean_type(detail::sqrt(variance().count())); }
+  };
+
+}  // namespace units
@@ -0,0 +1,368 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity_file.h"
+#include "simd.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <system_error>
+#include <type_traits>
+
+namespace units {
+
+  // Wire format of a batch of integral quantities:
+  //   tag:      'Q', version, rep, exponent count, exponents (zig-zag id and value), num, den, count (LEB128)
+  //   payload:  zig-zag deltas of consecutive values in groups of two, each group a control byte holding the byte
+  //             lengths (1-8) of both deltas in its low and high nibble followed by their little-endian bytes
+  // The tag carries the same unit information as a column_header and is checked in the same way on decode.
+
+  namespace detail {
+
+    constexpr std::uint8_t varint_magic = 'Q';
+    constexpr std::uint8_t varint_version = 1;
+
+    constexpr std::uint64_t zigzag_encode(std::uint64_t v)
+    {
+      return (v << 1) ^ (0 - (v >> 63));
+    }
+
+    constexpr std::uint64_t zigzag_decode(std::uint64_t v) { return (v >> 1) ^ (0 - (v & 1)); }
+
+    // the number of bytes (1-8) holding 'v'
+    constexpr int byte_length(std::uint64_t v)
+    {
+#if defined(__GNUC__)
+      return v == 0 ? 1 : (71 - __builtin_clzll(v)) / 8;
+#else
+      int n = 1;
+      while(n < 8 && (v >> (8 * n)) != 0) ++n;
+      return n;
+#endif
+    }
+
+    constexpr std::uint8_t* put_leb128(std::uint8_t* p, std::uint64_t v)
+    {
+      while(v >= 0x80) {
+        *p++ = static_cast<std::uint8_t>(v | 0x80);
+        v >>= 7;
+      }
+      *p++ = static_cast<std::uint8_t>(v);
+      return p;
+    }
+
+    // returns nullptr on a truncated or overlong value
+    constexpr const std::uint8_t* get_leb128(const std::uint8_t* p, const std::uint8_t* last, std::uint64_t& v)
+    {
+      v = 0;
+      for(int shift = 0; shift < 64 && p != last; shift += 7) {
+        const std::uint8_t b = *p++;
+        v |= std::uint64_t(b & 0x7F) << shift;
+        if((b & 0x80) == 0) return p;
+      }
+      return nullptr;
+    }
+
+    constexpr void put_le(std::uint8_t* p, std::uint64_t v)
+    {
+      for(int i = 0; i < 8; ++i) p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+
+    constexpr std::uint64_t get_le(const std::uint8_t* p, int n)
+    {
+      std::uint64_t v = 0;
+      for(int i = 0; i < n; ++i) v |= std::uint64_t(p[i]) << (8 * i);
+      return v;
+    }
+
+    // the largest tag: 4 bytes, 3 LEB128 values per exponent and 3 more for num, den and count
+    constexpr std::size_t max_varint_tag_size = 4 + 10 * (3 * column_header::max_exponents + 3);
+
+    constexpr std::uint8_t* put_varint_tag(std::uint8_t* p, const column_header& h)
+    {
+      *p++ = varint_magic;
+      *p++ = varint_version;
+      *p++ = static_cast<std::uint8_t>(h.rep);
+      *p++ = h.exponent_count;
+      for(std::size_t i = 0; i < h.exponent_count; ++i) {
+        p = put_leb128(p, zigzag_encode(static_cast<std::uint64_t>(std::int64_t(h.exponents[i].id))));
+        p = put_leb128(p, zigzag_encode(static_cast<std::uint64_t>(std::int64_t(h.exponents[i].value))));
+      }
+      p = put_leb128(p, static_cast<std::uint64_t>(h.num));
+      p = put_leb128(p, static_cast<std::uint64_t>(h.den));
+      return put_leb128(p, h.count);
+    }
+
+    // reads the tag into a column_header; returns nullptr if it is malformed
+    constexpr const std::uint8_t* get_varint_tag(const std::uint8_t* p, const std::uint8_t* last, column_header& h)
+    {
+      if(last - p < 4 || p[0] != varint_magic || p[1] != varint_version || p[3] > column_header::max_exponents)
+        return nullptr;
+      for(std::size_t i = 0; i < sizeof(h.magic); ++i) h.magic[i] = column_header::file_magic[i];
+      h.rep = static_cast<column_rep>(p[2]);
+      h.rep_size = h.rep == column_rep::int32 || h.rep == column_rep::uint32 ? 4 : 8;
+      h.exponent_count = p[3];
+      p += 4;
+      std::uint64_t id = 0, value = 0, num = 0, den = 0;
+      for(std::size_t i = 0; i < h.exponent_count; ++i) {
+        if((p = get_leb128(p, last, id)) == nullptr || (p = get_leb128(p, last, value)) == nullptr) return nullptr;
+        h.exponents[i] = {static_cast<std::int16_t>(zigzag_decode(id)), static_cast<std::int16_t>(zigzag_decode(value))};
+      }
+      if((p = get_leb128(p, last, num)) == nullptr || (p = get_leb128(p, last, den)) == nullptr ||
+         (p = get_leb128(p, last, h.count)) == nullptr)
+        return nullptr;
+      h.num = static_cast<std::int64_t>(num);
+      h.den = static_cast<std::int64_t>(den);
+      return p;
+    }
+
+    template<typename Rep>
+    inline constexpr bool is_varint_rep = std::is_integral_v<Rep> && !std::is_same_v<Rep, bool> &&
+                                          (sizeof(Rep) == 4 || sizeof(Rep) == 8);
+
+    template<typename Out>
+    constexpr Out varint_value(std::uint64_t v)
+    {
+      if constexpr(is_quantity<Out>)
+        return Out(static_cast<typename Out::rep>(v));
+      else
+        return static_cast<Out>(v);
+    }
+
+    // scalar group decoding; 'prev' is the last decoded value
+    template<typename Out>
+    constexpr const std::uint8_t* decode_groups_scalar(const std::uint8_t* p, const std::uint8_t* last,
+                                                       std::size_t count, std::uint64_t& prev, Out* out)
+    {
+      for(std::size_t i = 0; i < count; i += 2) {
+        if(p == last) return nullptr;
+        const int len0 = (*p & 0x7) + 1;
+        const int len1 = (*p >> 4 & 0x7) + 1;
+        ++p;
+        if(last - p < len0 + (i + 1 < count ? len1 : 0)) return nullptr;
+        prev += zigzag_decode(get_le(p, len0));
+        out[i] = varint_value<Out>(prev);
+        p += len0;
+        if(i + 1 < count) {
+          prev += zigzag_decode(get_le(p, len1));
+          out[i + 1] = varint_value<Out>(prev);
+          p += len1;
+        }
+      }
+      return p;
+    }
+
+#if defined(UNITS_SIMD_X86)
+
+    // for each control byte: the pshufb pattern gathering both deltas into two 64-bit lanes and the mask of their bytes
+    struct varint_shuffle {
+      signed char pattern[16];
+      signed char keep[16];
+    };
+
+    struct varint_shuffle_table {
+      varint_shuffle entries[256] = {};
+
+      constexpr varint_shuffle_table()
+      {
+        for(int ctrl = 0; ctrl < 256; ++ctrl) {
+          const int len0 = (ctrl & 0x7) + 1;
+          const int len1 = (ctrl >> 4 & 0x7) + 1;
+          for(int i = 0; i < 8; ++i) {
+            entries[ctrl].pattern[i] = static_cast<signed char>(i < len0 ? i : 0);
+            entries[ctrl].keep[i] = static_cast<signed char>(i < len0 ? -1 : 0);
+            entries[ctrl].pattern[8 + i] = static_cast<signed char>(i < len1 ? len0 + i : 0);
+            entries[ctrl].keep[8 + i] = static_cast<signed char>(i < len1 ? -1 : 0);
+          }
+        }
+      }
+    };
+
+    inline constexpr varint_shuffle_table varint_shuffles{};
+
+    // a group occupies at most 17 bytes, the 16-byte load after the control byte stays in [p, last)
+    template<typename Out>
+    [[gnu::target("avx2")]] const std::uint8_t* decode_groups_avx2(const std::uint8_t* p, const std::uint8_t* last,
+                                                                  std::size_t& i, std::size_t count,
+                                                                  std::uint64_t& prev, Out* out)
+    {
+      using B = simd::vec<signed char, 16>::type;
+      using Q = simd::vec<std::uint64_t, 16>::type;
+      B bytes{}, pattern{}, keep{};
+      Q deltas{};
+      for(; i + 2 <= count && last - p >= 17; i += 2) {
+        const varint_shuffle& s = varint_shuffles.entries[*p];
+        std::memcpy(&bytes, p + 1, 16);
+        std::memcpy(&pattern, s.pattern, 16);
+        std::memcpy(&keep, s.keep, 16);
+        bytes = __builtin_shuffle(bytes, pattern) & keep;
+        std::memcpy(&deltas, &bytes, 16);
+        deltas = (deltas >> 1) ^ (Q{} - (deltas & 1));
+        prev += deltas[0];
+        out[i] = varint_value<Out>(prev);
+        prev += deltas[1];
+        out[i + 1] = varint_value<Out>(prev);
+        p += 1 + (*p & 0x7) + (*p >> 4 & 0x7) + 2;
+      }
+      return p;
+    }
+
+#endif
+
+    template<typename Out>
+    constexpr const std::uint8_t* decode_groups(const std::uint8_t* p, const std::uint8_t* last, std::size_t count,
+                                                Out* out)
+    {
+      std::uint64_t prev = 0;
+      std::size_t i = 0;
+#if defined(UNITS_SIMD_X86)
+      if(!__builtin_is_constant_evaluated() && simd::detected_isa() >= simd::isa::avx2)
+        p = decode_groups_avx2(p, last, i, count, prev, out);
+#endif
+      return decode_groups_scalar(p, last, count - i, prev, out + i);
+    }
+
+  }  // namespace detail
+
+  // max_varint_size
+
+  // an upper bound of the encoded size of 'count' values, including 8 bytes of slack written past the end
+  constexpr std::size_t max_varint_size(std::size_t count)
+  {
+    return detail::max_varint_tag_size + (count + 1) / 2 * 17 + 8;
+  }
+
+  // varint_encode
+
+  // Encodes the values into 'out' (with room for max_varint_size(values.size()) bytes); returns the encoded size.
+  template<typename Unit, typename Rep>
+  constexpr std::size_t varint_encode(quantity_span<const quantity<Unit, Rep>> values, std::uint8_t* out)
+  {
+    static_assert(detail::is_varint_rep<Rep>, "varint encoding supports 32- and 64-bit integral representations");
+    std::uint8_t* p = detail::put_varint_tag(out, make_column_header<Unit, Rep>(values.size()));
+    std::uint64_t prev = 0;
+    for(std::size_t i = 0; i < values.size(); i += 2) {
+      // differences of the sign-extended values wrap around, the decoder wraps them back
+      const auto v0 = static_cast<std::uint64_t>(values[i].count());
+      const std::uint64_t d0 = detail::zigzag_encode(v0 - prev);
+      const std::uint64_t v1 = i + 1 < values.size() ? static_cast<std::uint64_t>(values[i + 1].count()) : v0;
+      const std::uint64_t d1 = detail::zigzag_encode(v1 - v0);
+      prev = v1;
+      const int len0 = detail::byte_length(d0);
+      const int len1 = detail::byte_length(d1);
+      *p++ = static_cast<std::uint8_t>((len0 - 1) | (len1 - 1) << 4);
+      detail::put_le(p, d0);
+      p += len0;
+      if(i + 1 < values.size()) {
+        detail::put_le(p, d1);
+        p += len1;
+      }
+    }
+    return static_cast<std::size_t>(p - out);
+  }
+
+  // any contiguous range of quantities (quantity_array, std::vector, a non-const quantity_span, ...)
+  template<typename Range,
+           typename Q = std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<const Range&>().data())>>,
+           Requires<is_quantity<Q>> = true>
+  constexpr std::size_t varint_encode(const Range& values, std::uint8_t* out)
+  {
+    return varint_encode(quantity_span<const Q>(values.data(), values.size()), out);
+  }
+
+  // varint_decode
+
+  struct varint_decode_result {
+    const std::uint8_t* ptr;
+    std::size_t count;
+    std::errc ec;
+  };
+
+  // Reads the tag of a batch at 'first' and decodes its values into 'out'. Values stored in a different unit or
+  // representation of the same dimension are rescaled exactly. On error the content of 'out' is unspecified:
+  //  - std::errc::invalid_argument         a malformed or truncated batch
+  //  - std::errc::argument_out_of_domain   a different dimension than the one of 'Unit'
+  //  - std::errc::value_too_large          'out' is smaller than the batch
+  //  - std::errc::result_out_of_range      a rescaled value does not fit in 'Rep'
+  template<typename Unit, typename Rep>
+  constexpr varint_decode_result varint_decode(const std::uint8_t* first, const std::uint8_t* last,
+                                     quantity_span<quantity<Unit, Rep>> out)
+  {
+    static_assert(detail::is_varint_rep<Rep>, "varint encoding supports 32- and 64-bit integral representations");
+    column_header stored;
+    const std::uint8_t* p = detail::get_varint_tag(first, last, stored);
+    if(p == nullptr) return {first, 0, std::errc::invalid_argument};
+    if(const std::errc ec = check_column_header(stored, make_column_header<Unit, Rep>()); ec != std::errc())
+      return {first, 0, ec};
+    if(stored.rep != column_rep::int32 && stored.rep != column_rep::int64 && stored.rep != column_rep::uint32 &&
+       stored.rep != column_rep::uint64)
+      return {first, 0, std::errc::invalid_argument};
+    if(stored.count > out.size()) return {first, 0, std::errc::value_too_large};
+    const auto count = static_cast<std::size_t>(stored.count);
+
+    if(stored.rep == detail::column_rep_of<Rep>() && stored.num == Unit::ratio::num && stored.den == Unit::ratio::den) {
+      p = detail::decode_groups(p, last, count, out.data());
+      if(p == nullptr) return {first, 0, std::errc::invalid_argument};
+      return {p, count, std::errc()};
+    }
+
+    // a different unit or rep: decoded in chunks and rescaled like read() of a column
+    const std::int64_t g1 = std::gcd(stored.num, std::int64_t(Unit::ratio::num));
+    const std::int64_t g2 = std::gcd(stored.den, std::int64_t(Unit::ratio::den));
+    const auto num = static_cast<detail::column_wide>(stored.num / g1) * (Unit::ratio::den / g2);
+    const auto den = static_cast<detail::column_wide>(stored.den / g2) * (Unit::ratio::num / g1);
+    const bool is_signed = stored.rep == column_rep::int32 || stored.rep == column_rep::int64;
+    const bool is_narrow = stored.rep_size == 4;
+    std::int64_t chunk[256] = {};
+    std::uint64_t prev = 0;
+    for(std::size_t i = 0; i < count; i += 256) {
+      const std::size_t n = std::min<std::size_t>(256, count - i);
+      p = detail::decode_groups_scalar(p, last, n, prev, chunk);
+      if(p == nullptr) return {first, 0, std::errc::invalid_argument};
+      for(std::size_t j = 0; j < n; ++j) {
+        detail::column_wide v = 0;
+        if(is_signed)
+          v = is_narrow ? std::int32_t(chunk[j]) : chunk[j];
+        else
+          v = is_narrow ? std::uint32_t(chunk[j]) : static_cast<detail::column_wide>(static_cast<std::uint64_t>(chunk[j]));
+        v = v * num / den;
+        if(v < std::numeric_limits<Rep>::min() || v > std::numeric_limits<Rep>::max())
+          return {first, 0, std::errc::result_out_of_range};
+        out[i + j] = quantity<Unit, Rep>(static_cast<Rep>(v));
+      }
+    }
+    return {p, count, std::errc()};
+  }
+
+  // any contiguous range of mutable quantities (quantity_array, std::vector, std::array, ...)
+  template<typename Range, typename Q = std::remove_pointer_t<decltype(std::declval<Range&>().data())>,
+           Requires<is_quantity<Q>> = true>
+  constexpr varint_decode_result varint_decode(const std::uint8_t* first, const std::uint8_t* last, Range&& out)
+  {
+    return varint_decode(first, last, quantity_span<Q>(out.data(), out.size()));
+  }
+
+}  // namespace units
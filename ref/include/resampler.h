@@ -0,0 +1,302 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "const_division.h"
+#include "frequency.h"
+#include "quantity_algorithm.h"
+#include "time.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <system_error>
+#include <type_traits>
+
+namespace units {
+
+  namespace detail {
+
+    constexpr int128 floor_div(int128 n, int128 d) { return n / d - (n % d != 0 && (n < 0) != (d < 0)); }
+    constexpr int128 ceil_div(int128 n, int128 d) { return -floor_div(-n, d); }
+
+    constexpr int128 gcd(int128 a, int128 b)
+    {
+      while(b != 0) {
+        const int128 r = a % b;
+        a = b;
+        b = r;
+      }
+      return a;
+    }
+
+    [[noreturn]] inline void throw_invalid_argument(const char* what)
+    {
+      throw std::system_error(std::make_error_code(std::errc::invalid_argument), what);
+    }
+
+    // the first position in a non-decreasing run whose value is not below 'v'
+    template<typename Rep, typename Q>
+    constexpr std::size_t first_not_below(const Q* p, std::size_t first, std::size_t last, Rep v)
+    {
+      while(first < last) {
+        const std::size_t mid = first + (last - first) / 2;
+        if(p[mid].count() < v)
+          first = mid + 1;
+        else
+          last = mid;
+      }
+      return first;
+    }
+
+  }  // namespace detail
+
+  // resampler
+
+  // Streaming downsampler of a time series of 'Value' samples with 'Time' timestamps into consecutive windows of equal
+  // length, reporting the number of samples and their mean, minimum, maximum and last value for every window that
+  // received any. The window length is given directly or as an output rate and kept as an exact fraction of 'Time'
+  // ticks: window k spans [origin + ceil(k * length), origin + ceil((k + 1) * length)), so e.g. 3 Hz over millisecond
+  // timestamps yields windows of 333, 334 and 333 ms without drift. The constructors throw std::system_error with
+  // std::errc::invalid_argument for a non-positive length, or a floating-point one that is neither a whole number nor
+  // the reciprocal of one.
+  //
+  // Timestamps must be non-decreasing. Samples of a batch that fall into one window are aggregated by vectorizable
+  // loops; the state is a single window regardless of the input length.
+  template<typename Value, typename Time = quantity<millisecond, std::int64_t>>
+  class resampler {
+    static_assert(is_quantity<Value> && is_quantity<Time>, "resampler works on units::quantity samples");
+    static_assert(std::is_same_v<typename Time::unit::dimension, dimension_time>, "timestamps must be durations");
+    static_assert(std::is_integral_v<typename Time::rep>, "window boundaries are computed in integral time");
+
+  public:
+    using time_type = Time;
+    using value_type = Value;
+    using mean_type = quantity<typename Value::unit, std::common_type_t<typename Value::rep, double>>;
+
+    struct window {
+      std::int64_t index;  // number of window lengths since the origin
+      Time start;
+      Time end;  // exclusive
+      std::size_t count;
+      mean_type mean;
+      Value min;
+      Value max;
+      Value last;
+    };
+
+  private:
+    using ticks = typename Time::rep;
+    using rep = typename Value::rep;
+    using acc = accumulator_rep<rep>;
+
+    std::int64_t num_ = 1;  // window length in ticks is num_ / den_
+    std::int64_t den_ = 1;
+    Time origin_;
+
+    bool open_ = false;
+    std::int64_t index_ = 0;
+    ticks end_ = 0;
+    std::size_t count_ = 0;
+    acc sum_{};
+    rep min_{};
+    rep max_{};
+    rep last_{};
+
+    // 'count' times the compile-time factor 'num' / 'den' as a reduced fraction of ticks
+    constexpr void set_length(detail::int128 num, detail::int128 den, const char* what)
+    {
+      if(num <= 0 || den <= 0) detail::throw_invalid_argument(what);
+      const detail::int128 g = detail::gcd(num, den);
+      num /= g;
+      den /= g;
+      if(num > std::numeric_limits<std::int64_t>::max() || den > std::numeric_limits<std::int64_t>::max())
+        detail::throw_invalid_argument(what);
+      num_ = static_cast<std::int64_t>(num);
+      den_ = static_cast<std::int64_t>(den);
+    }
+
+    // an integral count, or one whose reciprocal is integral (then 'inverted' is set)
+    template<typename Rep2>
+    static constexpr std::int64_t whole(const Rep2& count, bool& inverted, const char* what)
+    {
+      inverted = false;
+      if constexpr(treat_as_floating_point<Rep2>) {
+        if(!(count > 0) || count >= Rep2(std::numeric_limits<std::int64_t>::max()))
+          detail::throw_invalid_argument(what);
+        if(const auto n = static_cast<std::int64_t>(count); Rep2(n) == count) return n;
+        const Rep2 r = Rep2(1) / count;
+        if(const auto n = static_cast<std::int64_t>(r); Rep2(n) == r) {
+          inverted = true;
+          return n;
+        }
+        detail::throw_invalid_argument(what);
+      }
+      else {
+        return static_cast<std::int64_t>(count);
+      }
+    }
+
+    constexpr std::int64_t index_of(ticks t) const
+    {
+      return static_cast<std::int64_t>(detail::floor_div(detail::int128(t - origin_.count()) * den_, num_));
+    }
+
+    constexpr void open(ticks t)
+    {
+      open_ = true;
+      index_ = index_of(t);
+      end_ = start_of(index_ + 1).count();
+      count_ = 0;
+      sum_ = acc{};
+    }
+
+    // one pass over independent lanes, which the compiler turns into vector additions, minimums and maximums
+    constexpr void add(const Value* p, std::size_t n)
+    {
+      constexpr std::size_t lanes = 8;
+      acc sum[lanes]{};
+      rep lo[lanes]{};
+      rep hi[lanes]{};
+      for(std::size_t j = 0; j < lanes; ++j) {
+        lo[j] = count_ == 0 ? p[0].count() : min_;
+        hi[j] = count_ == 0 ? p[0].count() : max_;
+      }
+      std::size_t i = 0;
+      for(; i + lanes <= n; i += lanes)
+        for(std::size_t j = 0; j < lanes; ++j) {
+          const rep x = p[i + j].count();
+          sum[j] += acc(x);
+          lo[j] = x < lo[j] ? x : lo[j];
+          hi[j] = x > hi[j] ? x : hi[j];
+        }
+      for(; i < n; ++i) {
+        const rep x = p[i].count();
+        sum[0] += acc(x);
+        lo[0] = x < lo[0] ? x : lo[0];
+        hi[0] = x > hi[0] ? x : hi[0];
+      }
+      for(std::size_t j = 0; j < lanes; ++j) {
+        sum_ += sum[j];
+        lo[0] = lo[j] < lo[0] ? lo[j] : lo[0];
+        hi[0] = hi[j] > hi[0] ? hi[j] : hi[0];
+      }
+      min_ = lo[0];
+      max_ = hi[0];
+      last_ = p[n - 1].count();
+      count_ += n;
+    }
+
+    constexpr window close()
+    {
+      open_ = false;
+      using mean_rep = typename mean_type::rep;
+      return window{index_,
+                    start_of(index_),
+                    Time(end_),
+                    count_,
+                    mean_type(mean_rep(sum_) / mean_rep(count_)),
+                    Value(min_),
+                    Value(max_),
+                    Value(last_)};
+    }
+
+  public:
+    // windows of the given length, aligned to 'origin'
+    template<typename Unit2, typename Rep2, Requires<same_dim<Unit2, typename Time::unit>> = true>
+    constexpr explicit resampler(const quantity<Unit2, Rep2>& length, const Time& origin = Time::zero())
+        : origin_(origin)
+    {
+      using k = std::ratio_divide<typename Unit2::ratio, typename Time::unit::ratio>;
+      bool inverted = false;
+      const std::int64_t n = whole(length.count(), inverted, "resampler window");
+      if(inverted)
+        set_length(k::num, detail::int128(k::den) * n, "resampler window");
+      else
+        set_length(detail::int128(k::num) * n, k::den, "resampler window");
+    }
+
+    // windows of one period of the given output rate, aligned to 'origin'
+    template<typename Unit2, typename Rep2,
+             Requires<same_dim<typename Unit2::dimension, dim_invert<dimension_time>>> = true>
+    constexpr explicit resampler(const quantity<Unit2, Rep2>& rate, const Time& origin = Time::zero())
+        : origin_(origin)
+    {
+      using k = std::ratio_multiply<typename Unit2::ratio, typename Time::unit::ratio>;
+      bool inverted = false;
+      const std::int64_t n = whole(rate.count(), inverted, "resampler rate");
+      if(inverted)
+        set_length(detail::int128(k::den) * n, k::num, "resampler rate");
+      else
+        set_length(k::den, detail::int128(k::num) * n, "resampler rate");
+    }
+
+    // the first tick of window 'index'
+    [[nodiscard]] constexpr Time start_of(std::int64_t index) const
+    {
+      return Time(static_cast<ticks>(origin_.count() + detail::ceil_div(detail::int128(index) * num_, den_)));
+    }
+
+    // adds a batch of samples; 'emit' is called with every window completed by it. 'times' and 'values' must be
+    // equally long (std::errc::invalid_argument otherwise, before anything is added).
+    template<typename F>
+    constexpr void push(quantity_span<const Time> times, quantity_span<const Value> values, F&& emit)
+    {
+      if(times.size() != values.size()) detail::throw_invalid_argument("resampler samples");
+      const std::size_t n = times.size();
+      const Time* t = times.data();
+      for(std::size_t i = 0; i < n;) {
+        if(!open_ || t[i].count() >= end_) {
+          if(open_) emit(close());
+          open(t[i].count());
+        }
+        const std::size_t j = detail::first_not_below(t, i + 1, n, end_);
+        add(values.data() + i, j - i);
+        i = j;
+      }
+    }
+
+    template<typename F>
+    constexpr void push(const Time& time, const Value& value, F&& emit)
+    {
+      if(!open_ || time.count() >= end_) {
+        if(open_) emit(close());
+        open(time.count());
+      }
+      const rep x = value.count();
+      min_ = count_ == 0 || x < min_ ? x : min_;
+      max_ = count_ == 0 || x > max_ ? x : max_;
+      sum_ += acc(x);
+      last_ = x;
+      ++count_;
+    }
+
+    // emits the window in progress, if any
+    template<typename F>
+    constexpr void flush(F&& emit)
+    {
+      if(open_) emit(close());
+    }
+  };
+
+}  // namespace units
@@ -0,0 +1,163 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "frequency.h"
+#include "time.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace units {
+
+  // timed_sample
+
+  template<typename T>
+  struct timed_sample {
+    quantity<nanosecond, std::int64_t> time;
+    T value;
+  };
+
+  // sample_queue
+
+  // A bounded lock-free queue of timed samples for one producer and one consumer thread, with an estimate of the rate
+  // at which the producer offers samples. The two counters live on separate pairs of cache lines and each side keeps
+  // a private copy of the other side's counter, so neither touches the other's line while there is room (or data).
+  //
+  // The rate is counted in 'rate_buckets' buckets that together span the estimation window; each bucket is a single
+  // 64-bit word holding its epoch (time / bucket width) and count, so the producer updates it with one plain store
+  // (wait-free) and rate() can be called from any thread.
+  template<typename T>
+  class sample_queue {
+    static_assert(std::is_nothrow_copy_assignable_v<T> && std::is_default_constructible_v<T>,
+                  "sample_queue stores copies of default-constructible values");
+
+  public:
+    using value_type = timed_sample<T>;
+    using time_type = quantity<nanosecond, std::int64_t>;
+
+    static constexpr std::size_t rate_buckets = 16;
+
+  private:
+    static constexpr std::size_t padding = 128;
+
+    struct alignas(padding) counter {
+      std::atomic<std::uint64_t> value{0};
+    };
+
+    counter head_;  // written by the consumer
+    counter tail_;  // written by the producer
+    alignas(padding) std::uint64_t cached_head_ = 0;  // producer side
+    std::int64_t bucket_epoch_ = -1;                   // producer side
+    std::uint64_t bucket_count_ = 0;                   // producer side
+    alignas(padding) std::uint64_t cached_tail_ = 0;  // consumer side
+    alignas(padding) std::atomic<std::uint64_t> buckets_[rate_buckets] = {};
+    std::unique_ptr<value_type[]> slots_;
+    std::uint64_t mask_;
+    std::int64_t bucket_width_;  // ns
+
+    static constexpr std::int64_t epoch_of(std::int64_t t, std::int64_t width)
+    {
+      return t / width - (t % width < 0);
+    }
+
+    void count(const time_type& time) noexcept
+    {
+      const std::int64_t epoch = epoch_of(time.count(), bucket_width_);
+      if(epoch != bucket_epoch_) {
+        bucket_epoch_ = epoch;
+        bucket_count_ = 0;
+      }
+      ++bucket_count_;
+      buckets_[static_cast<std::uint64_t>(epoch) % rate_buckets].store(
+          (static_cast<std::uint64_t>(epoch) << 32) | (bucket_count_ & 0xFFFF'FFFF), std::memory_order_relaxed);
+    }
+
+  public:
+    // 'capacity' is rounded up to a power of 2; the rate is estimated over the last 'window' (at least 16 ns)
+    template<typename Unit, typename Rep, Requires<std::is_convertible_v<quantity<Unit, Rep>, time_type>> = true>
+    explicit sample_queue(std::size_t capacity, const quantity<Unit, Rep>& window)
+    {
+      std::size_t n = 1;
+      while(n < capacity) n *= 2;
+      slots_ = std::make_unique<value_type[]>(n);
+      mask_ = n - 1;
+      const std::int64_t width = time_type(window).count() / std::int64_t(rate_buckets);
+      bucket_width_ = width > 0 ? width : 1;
+    }
+
+    explicit sample_queue(std::size_t capacity) : sample_queue(capacity, quantity<second, std::int64_t>(1)) {}
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return static_cast<std::size_t>(mask_ + 1); }
+
+    // producer: counts the sample for the rate and enqueues it if there is room
+    bool try_push(const value_type& sample) noexcept
+    {
+      count(sample.time);
+      const std::uint64_t pos = tail_.value.load(std::memory_order_relaxed);
+      if(pos - cached_head_ > mask_) {
+        cached_head_ = head_.value.load(std::memory_order_acquire);
+        if(pos - cached_head_ > mask_) return false;
+      }
+      slots_[pos & mask_] = sample;
+      tail_.value.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool try_push(const time_type& time, const T& value) noexcept { return try_push(value_type{time, value}); }
+
+    // consumer: dequeues up to 'max' samples into 'out'; returns their number
+    std::size_t try_pop(value_type* out, std::size_t max) noexcept
+    {
+      const std::uint64_t pos = head_.value.load(std::memory_order_relaxed);
+      if(cached_tail_ - pos < max) cached_tail_ = tail_.value.load(std::memory_order_acquire);
+      const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(max, cached_tail_ - pos));
+      for(std::size_t i = 0; i < n; ++i) out[i] = slots_[(pos + i) & mask_];
+      if(n != 0) head_.value.store(pos + n, std::memory_order_release);
+      return n;
+    }
+
+    bool try_pop(value_type& out) noexcept { return try_pop(&out, 1) == 1; }
+
+    // any thread: samples offered per second over the window ending at 'now'
+    [[nodiscard]] quantity<hertz, double> rate(const time_type& now) const noexcept
+    {
+      const std::int64_t epoch = epoch_of(now.count(), bucket_width_);
+      std::uint64_t total = 0;
+      for(const auto& b : buckets_) {
+        const std::uint64_t v = b.load(std::memory_order_relaxed);
+        const auto age = static_cast<std::uint32_t>(static_cast<std::uint64_t>(epoch) - (v >> 32));
+        if(age < rate_buckets) total += v & 0xFFFF'FFFF;
+      }
+      // the oldest buckets are complete and the current one is filled up to 'now'
+      const std::int64_t elapsed =
+          std::int64_t(rate_buckets - 1) * bucket_width_ + (now.count() - epoch * bucket_width_) + 1;
+      const auto seconds = quantity_cast<quantity<second, double>>(time_type(elapsed));
+      return static_cast<double>(total) / seconds;
+    }
+  };
+
+}  // namespace units
@@ -0,0 +1,127 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "quantity_atomic.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+namespace units {
+
+  namespace detail {
+
+    // each thread picks its shard once; consecutive threads land on different shards
+    inline std::size_t thread_shard_seed() noexcept
+    {
+      static std::atomic<std::size_t> next{0};
+      thread_local const std::size_t seed = next.fetch_add(1, std::memory_order_relaxed);
+      return seed;
+    }
+
+  }  // namespace detail
+
+  // sharded_quantity
+
+  // An accumulator for quantities updated by many threads. Every thread adds to one of a power-of-2 number of
+  // accumulators, each on its own pair of cache lines, so increments from different cores do not contend; load()
+  // merges them in the stored unit and converts the total to the requested one.
+  template<typename Unit, typename Rep = double>
+  class sharded_quantity {
+  public:
+    using value_type = quantity<Unit, Rep>;
+
+  private:
+    struct alignas(128) shard {
+      std::atomic<value_type> value{value_type::zero()};
+    };
+
+    std::unique_ptr<shard[]> shards_;
+    std::size_t mask_;
+
+    static std::size_t default_shards() noexcept
+    {
+      const unsigned cores = std::thread::hardware_concurrency();
+      return cores == 0 ? 1 : cores;
+    }
+
+    std::atomic<value_type>& local() noexcept { return shards_[detail::thread_shard_seed() & mask_].value; }
+
+  public:
+    // 'shards' is rounded up to a power of 2; by default there is one per hardware thread
+    explicit sharded_quantity(std::size_t shards = default_shards())
+    {
+      std::size_t n = 1;
+      while(n < shards) n *= 2;
+      shards_ = std::make_unique<shard[]>(n);
+      mask_ = n - 1;
+    }
+
+    [[nodiscard]] std::size_t shards() const noexcept { return mask_ + 1; }
+
+    template<typename Unit2, typename Rep2, Requires<detail::atomic_operand<value_type, quantity<Unit2, Rep2>>> = true>
+    void add(const quantity<Unit2, Rep2>& q) noexcept
+    {
+      local().fetch_add(q, std::memory_order_relaxed);
+    }
+    template<typename Unit2, typename Rep2, Requires<detail::atomic_operand<value_type, quantity<Unit2, Rep2>>> = true>
+    void sub(const quantity<Unit2, Rep2>& q) noexcept
+    {
+      local().fetch_sub(q, std::memory_order_relaxed);
+    }
+
+    template<typename Unit2, typename Rep2, Requires<detail::atomic_operand<value_type, quantity<Unit2, Rep2>>> = true>
+    sharded_quantity& operator+=(const quantity<Unit2, Rep2>& q) noexcept
+    {
+      add(q);
+      return *this;
+    }
+    template<typename Unit2, typename Rep2, Requires<detail::atomic_operand<value_type, quantity<Unit2, Rep2>>> = true>
+    sharded_quantity& operator-=(const quantity<Unit2, Rep2>& q) noexcept
+    {
+      sub(q);
+      return *this;
+    }
+
+    // the sum of all shards; concurrent updates may or may not be included
+    template<typename To = value_type>
+    [[nodiscard]] To load() const noexcept
+    {
+      value_type total = value_type::zero();
+      for(std::size_t i = 0; i <= mask_; ++i) total += shards_[i].value.load(std::memory_order_relaxed);
+      return quantity_cast<To>(common_quantity<value_type, To>(total));
+    }
+
+    // returns the sum and zeroes the shards; every update lands in exactly one of the returned totals
+    template<typename To = value_type>
+    To exchange_zero() noexcept
+    {
+      value_type total = value_type::zero();
+      for(std::size_t i = 0; i <= mask_; ++i)
+        total += shards_[i].value.exchange(value_type::zero(), std::memory_order_relaxed);
+      return quantity_cast<To>(common_quantity<value_type, To>(total));
+    }
+  };
+
+}  // namespace units
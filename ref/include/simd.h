@@ -0,0 +1,326 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "const_division.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UNITS_SIMD_X86 1
+#elif defined(__GNUC__)
+#define UNITS_SIMD_GENERIC 1
+#endif
+
+namespace units::detail::simd {
+
+  // op
+
+  enum class op { add, sub, mul, div };
+
+  template<op O, typename T1, typename T2>
+  constexpr auto apply(const T1& lhs, const T2& rhs)
+  {
+    if constexpr(O == op::add)
+      return lhs + rhs;
+    else if constexpr(O == op::sub)
+      return lhs - rhs;
+    else if constexpr(O == op::mul)
+      return lhs * rhs;
+    else
+      return lhs / rhs;
+  }
+
+  // is_vectorizable
+
+  template<typename T>
+  inline constexpr bool is_vectorizable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+  // isa
+
+  enum class isa { scalar, sse2, avx2, avx512 };
+
+  inline isa detected_isa()
+  {
+#if defined(UNITS_SIMD_X86)
+    static const isa value = [] {
+      __builtin_cpu_init();
+      if(__builtin_cpu_supports("avx512f")) return isa::avx512;
+      if(__builtin_cpu_supports("avx2")) return isa::avx2;
+      if(__builtin_cpu_supports("sse2")) return isa::sse2;
+      return isa::scalar;
+    }();
+    return value;
+#else
+    return isa::scalar;
+#endif
+  }
+
+  // scalar kernel
+
+  // LhsScalar/RhsScalar select broadcasting of a single value pointed to by lhs/rhs
+  template<op O, bool LhsScalar, bool RhsScalar, typename T>
+  void transform_scalar(const T* lhs, const T* rhs, T* out, std::size_t n)
+  {
+    for(std::size_t i = 0; i < n; ++i) out[i] = apply<O>(lhs[LhsScalar ? 0 : i], rhs[RhsScalar ? 0 : i]);
+  }
+
+#if defined(UNITS_SIMD_X86) || defined(UNITS_SIMD_GENERIC)
+
+  // vector kernel
+
+  template<typename T, std::size_t Bytes>
+  struct vec {
+    typedef T type __attribute__((vector_size(Bytes)));
+    static constexpr std::size_t size = Bytes / sizeof(T);
+  };
+
+  // vector types never cross a function boundary here so that no ABI depends on the enabled ISA
+  template<std::size_t Bytes, op O, bool LhsScalar, bool RhsScalar, typename T>
+  [[gnu::always_inline]] inline void transform_vec(const T* lhs, const T* rhs, T* out, std::size_t n)
+  {
+    using v = vec<T, Bytes>;
+    using V = typename v::type;
+    V a{}, b{}, res{};
+    if constexpr(LhsScalar) a = a + *lhs;
+    if constexpr(RhsScalar) b = b + *rhs;
+    std::size_t i = 0;
+    for(; i + v::size <= n; i += v::size) {
+      if constexpr(!LhsScalar) std::memcpy(&a, lhs + i, sizeof(V));
+      if constexpr(!RhsScalar) std::memcpy(&b, rhs + i, sizeof(V));
+      if constexpr(O == op::add)
+        res = a + b;
+      else if constexpr(O == op::sub)
+        res = a - b;
+      else if constexpr(O == op::mul)
+        res = a * b;
+      else
+        res = a / b;
+      std::memcpy(out + i, &res, sizeof(V));
+    }
+    for(; i < n; ++i) out[i] = apply<O>(lhs[LhsScalar ? 0 : i], rhs[RhsScalar ? 0 : i]);
+  }
+
+#endif
+
+#if defined(UNITS_SIMD_X86)
+
+  template<op O, bool LhsScalar, bool RhsScalar, typename T>
+  [[gnu::target("sse2")]] void transform_sse2(const T* lhs, const T* rhs, T* out, std::size_t n)
+  {
+    transform_vec<16, O, LhsScalar, RhsScalar>(lhs, rhs, out, n);
+  }
+
+  template<op O, bool LhsScalar, bool RhsScalar, typename T>
+  [[gnu::target("avx2")]] void transform_avx2(const T* lhs, const T* rhs, T* out, std::size_t n)
+  {
+    transform_vec<32, O, LhsScalar, RhsScalar>(lhs, rhs, out, n);
+  }
+
+  template<op O, bool LhsScalar, bool RhsScalar, typename T>
+  [[gnu::target("avx512f")]] void transform_avx512(const T* lhs, const T* rhs, T* out, std::size_t n)
+  {
+    transform_vec<64, O, LhsScalar, RhsScalar>(lhs, rhs, out, n);
+  }
+
+#endif
+
+  // transform
+
+  template<op O, bool LhsScalar, bool RhsScalar, typename T>
+  void transform(const T* lhs, const T* rhs, T* out, std::size_t n)
+  {
+    static_assert(is_vectorizable<T>);
+#if defined(UNITS_SIMD_X86)
+    switch(detected_isa()) {
+      case isa::avx512: return transform_avx512<O, LhsScalar, RhsScalar>(lhs, rhs, out, n);
+      case isa::avx2: return transform_avx2<O, LhsScalar, RhsScalar>(lhs, rhs, out, n);
+      case isa::sse2: return transform_sse2<O, LhsScalar, RhsScalar>(lhs, rhs, out, n);
+      case isa::scalar: break;
+    }
+#elif defined(UNITS_SIMD_GENERIC)
+    return transform_vec<16, O, LhsScalar, RhsScalar>(lhs, rhs, out, n);
+#endif
+    transform_scalar<O, LhsScalar, RhsScalar>(lhs, rhs, out, n);
+  }
+
+  // scale
+
+  // mirrors detail::quantity_cast_impl operation by operation so that the results are bit-identical
+  template<typename To, typename CRep, std::intmax_t Num, std::intmax_t Den, typename From>
+  constexpr To scale_one(const From& v)
+  {
+    if constexpr(Num == 1 && Den == 1)
+      return static_cast<To>(v);
+    else if constexpr(Num == 1)
+      return static_cast<To>(divide<Den>(static_cast<CRep>(v)));
+    else if constexpr(Den == 1)
+      return static_cast<To>(static_cast<CRep>(v) * static_cast<CRep>(Num));
+    else if constexpr(may_overflow_multiply<CRep, From, Num>())
+      return static_cast<To>(multiply_divide<Num, Den>(static_cast<CRep>(v)));
+    else
+      return static_cast<To>(divide<Den>(static_cast<CRep>(v) * static_cast<CRep>(Num)));
+  }
+
+  template<typename CRep, std::intmax_t Num, std::intmax_t Den, typename From, typename To>
+  void scale_scalar(const From* in, To* out, std::size_t n)
+  {
+    for(std::size_t i = 0; i < n; ++i) out[i] = scale_one<To, CRep, Num, Den>(in[i]);
+  }
+
+#if defined(UNITS_SIMD_X86) || defined(UNITS_SIMD_GENERIC)
+
+  // 'in' and 'out' may be the same buffer
+  template<std::size_t Bytes, typename CRep, std::intmax_t Num, std::intmax_t Den, typename From, typename To>
+  [[gnu::always_inline]] inline void scale_vec(const From* in, To* out, std::size_t n)
+  {
+    std::size_t i = 0;
+    constexpr bool split = Num != 1 && Den != 1 && may_overflow_multiply<CRep, From, Num>();
+    if constexpr(std::is_same_v<From, CRep> && std::is_same_v<To, CRep> && !split) {
+      using v = vec<CRep, Bytes>;
+      using V = typename v::type;
+      const V num = V{} + static_cast<CRep>(Num);
+      const V den = V{} + static_cast<CRep>(Den);
+      V x{};
+      for(; i + v::size <= n; i += v::size) {
+        std::memcpy(&x, in + i, sizeof(V));
+        if constexpr(Num != 1) x = x * num;
+        if constexpr(Den != 1) x = x / den;
+        std::memcpy(out + i, &x, sizeof(V));
+      }
+    }
+    for(; i < n; ++i) out[i] = scale_one<To, CRep, Num, Den>(in[i]);
+  }
+
+#endif
+
+#if defined(UNITS_SIMD_X86)
+
+  template<typename CRep, std::intmax_t Num, std::intmax_t Den, typename From, typename To>
+  [[gnu::target("sse2")]] void scale_sse2(const From* in, To* out, std::size_t n)
+  {
+    scale_vec<16, CRep, Num, Den>(in, out, n);
+  }
+
+  template<typename CRep, std::intmax_t Num, std::intmax_t Den, typename From, typename To>
+  [[gnu::target("avx2")]] void scale_avx2(const From* in, To* out, std::size_t n)
+  {
+    scale_vec<32, CRep, Num, Den>(in, out, n);
+  }
+
+  template<typename CRep, std::intmax_t Num, std::intmax_t Den, typename From, typename To>
+  [[gnu::target("avx512f")]] void scale_avx512(const From* in, To* out, std::size_t n)
+  {
+    scale_vec<64, CRep, Num, Den>(in, out, n);
+  }
+
+#endif
+
+  template<typename CRep, std::intmax_t Num, std::intmax_t Den, typename From, typename To>
+  void scale(const From* in, To* out, std::size_t n)
+  {
+    static_assert(is_vectorizable<From> && is_vectorizable<To>);
+#if defined(UNITS_SIMD_X86)
+    switch(detected_isa()) {
+      case isa::avx512: return scale_avx512<CRep, Num, Den>(in, out, n);
+      case isa::avx2: return scale_avx2<CRep, Num, Den>(in, out, n);
+      case isa::sse2: return scale_sse2<CRep, Num, Den>(in, out, n);
+      case isa::scalar: break;
+    }
+#elif defined(UNITS_SIMD_GENERIC)
+    return scale_vec<16, CRep, Num, Den>(in, out, n);
+#endif
+    scale_scalar<CRep, Num, Den>(in, out, n);
+  }
+
+  // count
+
+  inline std::size_t count_scalar(const char* p, std::size_t n, char c)
+  {
+    std::size_t count = 0;
+    for(std::size_t i = 0; i < n; ++i) count += p[i] == c;
+    return count;
+  }
+
+#if defined(UNITS_SIMD_X86) || defined(UNITS_SIMD_GENERIC)
+
+  // the 0/-1 lanes of the comparisons are accumulated for up to 255 vectors before the horizontal sum
+  template<std::size_t Bytes>
+  [[gnu::always_inline]] inline std::size_t count_vec(const char* p, std::size_t n, char c)
+  {
+    using V = typename vec<signed char, Bytes>::type;
+    V needle{}, v{};
+    needle = needle + static_cast<signed char>(c);
+    std::size_t count = 0;
+    std::size_t i = 0;
+    while(i + Bytes <= n) {
+      V acc{};
+      for(int k = 0; k < 255 && i + Bytes <= n; ++k, i += Bytes) {
+        std::memcpy(&v, p + i, Bytes);
+        acc -= v == needle;
+      }
+      for(std::size_t j = 0; j < Bytes; ++j) count += static_cast<unsigned char>(acc[j]);
+    }
+    return count + count_scalar(p + i, n - i, c);
+  }
+
+#endif
+
+#if defined(UNITS_SIMD_X86)
+
+  [[gnu::target("sse2")]] inline std::size_t count_sse2(const char* p, std::size_t n, char c)
+  {
+    return count_vec<16>(p, n, c);
+  }
+
+  [[gnu::target("avx2")]] inline std::size_t count_avx2(const char* p, std::size_t n, char c)
+  {
+    return count_vec<32>(p, n, c);
+  }
+
+  [[gnu::target("avx512f,avx512bw")]] inline std::size_t count_avx512(const char* p, std::size_t n, char c)
+  {
+    return count_vec<64>(p, n, c);
+  }
+
+#endif
+
+  // occurrences of 'c' in [p, p + n)
+  inline std::size_t count(const char* p, std::size_t n, char c)
+  {
+#if defined(UNITS_SIMD_X86)
+    switch(detected_isa()) {
+      case isa::avx512: return __builtin_cpu_supports("avx512bw") ? count_avx512(p, n, c) : count_avx2(p, n, c);
+      case isa::avx2: return count_avx2(p, n, c);
+      case isa::sse2: return count_sse2(p, n, c);
+      case isa::scalar: break;
+    }
+#elif defined(UNITS_SIMD_GENERIC)
+    return count_vec<16>(p, n, c);
+#endif
+    return count_scalar(p, n, c);
+  }
+
+}  // namespace units::detail::simd
@@ -0,0 +1,199 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "const_division.h"
+#include "frequency.h"
+#include "time.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UNITS_TSC_X86 1
+#include <x86intrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define UNITS_TSC_ARM64 1
+#endif
+
+namespace units {
+
+  // tsc_clock
+
+  // A clock reading the CPU time-stamp counter (rdtsc on x86, the virtual counter on AArch64, steady_clock
+  // elsewhere). The counter frequency is measured against steady_clock on first use (about 10 ms), after which ticks
+  // become nanoseconds with one 64x64-bit multiplication and a shift instead of a division. now() is aligned to the
+  // steady_clock epoch, so the two can be compared. The counter is assumed to be invariant and synchronized across
+  // cores, as it is on current x86 and AArch64 systems.
+  class tsc_clock {
+  public:
+    using duration = quantity<nanosecond, std::int64_t>;
+
+    static constexpr bool is_hardware =
+#if defined(UNITS_TSC_X86) || defined(UNITS_TSC_ARM64)
+        true;
+#else
+        false;
+#endif
+
+    struct calibration {
+      quantity<gigahertz, double> frequency;  // counter ticks per nanosecond
+      std::uint64_t base_ticks;
+      duration base_time;       // steady_clock time at 'base_ticks'
+      std::uint64_t multiplier;  // 2^32 nanoseconds per tick
+    };
+
+    static std::uint64_t ticks() noexcept
+    {
+#if defined(UNITS_TSC_X86)
+      return __rdtsc();
+#elif defined(UNITS_TSC_ARM64)
+      std::uint64_t v;
+      asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+      return v;
+#else
+      return static_cast<std::uint64_t>(steady_now().count());
+#endif
+    }
+
+    static const calibration& calibrated()
+    {
+      static const calibration c = calibrate();
+      return c;
+    }
+
+    [[nodiscard]] static quantity<gigahertz, double> frequency() { return calibrated().frequency; }
+
+    // the time of a tick count read by ticks()
+    [[nodiscard]] static duration to_time(std::uint64_t t) noexcept
+    {
+      const calibration& c = calibrated();
+      const auto delta = static_cast<std::int64_t>(t - c.base_ticks);
+      return c.base_time + duration(static_cast<std::int64_t>((detail::int128(delta) * c.multiplier) >> 32));
+    }
+
+    // the length of an interval of 'count' ticks
+    [[nodiscard]] static duration to_duration(std::uint64_t count) noexcept
+    {
+      return duration(static_cast<std::int64_t>((detail::uint128(count) * calibrated().multiplier) >> 32));
+    }
+
+    [[nodiscard]] static duration now() noexcept { return to_time(ticks()); }
+
+  private:
+    static duration steady_now() noexcept
+    {
+      using ns = std::chrono::nanoseconds;
+      return duration(std::chrono::duration_cast<ns>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static calibration calibrate()
+    {
+      const duration start = steady_now();
+      const std::uint64_t start_ticks = ticks();
+      duration end = start;
+      std::uint64_t end_ticks = start_ticks;
+      while((end - start).count() < 10'000'000) {
+        end = steady_now();
+        end_ticks = ticks();
+      }
+      const double ghz = static_cast<double>(end_ticks - start_ticks) / static_cast<double>((end - start).count());
+      const double ns_per_tick = ghz > 0 ? 1 / ghz : 1;
+      return calibration{quantity<gigahertz, double>(ghz), end_ticks, end,
+                         static_cast<std::uint64_t>(ns_per_tick * 4294967296.0 + 0.5)};
+    }
+  };
+
+  // trace_buffer
+
+  struct trace_event {
+    const char* name;
+    quantity<nanosecond, std::int64_t> start;
+    quantity<nanosecond, std::int64_t> duration;
+  };
+
+  // The last 'Capacity' events recorded by scoped_trace on the calling thread. Events keep raw counter ticks and are
+  // converted only when read, so recording is two counter reads and three stores.
+  template<std::size_t Capacity = 4096>
+  class trace_buffer {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+    struct raw_event {
+      const char* name;
+      std::uint64_t start;
+      std::uint64_t end;
+    };
+
+    std::array<raw_event, Capacity> events_{};
+    std::uint64_t next_ = 0;
+
+  public:
+    [[nodiscard]] static trace_buffer& local() noexcept
+    {
+      thread_local trace_buffer buffer;
+      return buffer;
+    }
+
+    void record(const char* name, std::uint64_t start, std::uint64_t end) noexcept
+    {
+      events_[next_++ & (Capacity - 1)] = raw_event{name, start, end};
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return next_ < Capacity ? next_ : Capacity; }
+
+    // the number of events overwritten since the last clear()
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return next_ - size(); }
+
+    void clear() noexcept { next_ = 0; }
+
+    // calls 'f' with every retained event, oldest first
+    template<typename F>
+    void for_each(F&& f) const
+    {
+      for(std::uint64_t i = next_ - size(); i < next_; ++i) {
+        const raw_event& e = events_[i & (Capacity - 1)];
+        f(trace_event{e.name, tsc_clock::to_time(e.start), tsc_clock::to_duration(e.end - e.start)});
+      }
+    }
+  };
+
+  // scoped_trace
+
+  // records the lifetime of the object under 'name' (which must outlive the buffer's events) in the thread's buffer
+  template<std::size_t Capacity = 4096>
+  class scoped_trace {
+    const char* name_;
+    std::uint64_t start_;
+
+  public:
+    explicit scoped_trace(const char* name) noexcept : name_(name), start_(tsc_clock::ticks()) {}
+    scoped_trace(const scoped_trace&) = delete;
+    scoped_trace& operator=(const scoped_trace&) = delete;
+    ~scoped_trace() { trace_buffer<Capacity>::local().record(name_, start_, tsc_clock::ticks()); }
+  };
+
+}  // namespace units
+
+#undef UNITS_TSC_X86
+#undef UNITS_TSC_ARM64
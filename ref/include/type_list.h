@@ -23,6 +23,7 @@
 #pragma once
 
 #include <type_traits>
+#include <utility>
 
 namespace units {
 
@@ -64,24 +65,27 @@ namespace units {
 
   namespace detail {
 
-    template<template<typename...> typename List, std::size_t Idx, std::size_t N, typename... Types>
-    struct split_impl;
-
-    template<template<typename...> typename List, std::size_t Idx, std::size_t N>
-    struct split_impl<List, Idx, N> {
-      using first_list = List<>;
-      using second_list = List<>;
+    template<std::size_t I, typename T>
+    struct indexed_type {
+      using type = T;
     };
 
-    template<template<typename...> typename List, std::size_t Idx, std::size_t N, typename T, typename... Rest>
-    struct split_impl<List, Idx, N, T, Rest...> : split_impl<List, Idx + 1, N, Rest...> {
-      using base = split_impl<List, Idx + 1, N, Rest...>;
-      using first_list = std::conditional_t<Idx < N,
-                                            typename type_list_push_front_impl<typename base::first_list, T>::type,
-                                            typename base::first_list>;
-      using second_list = std::conditional_t<Idx < N,
-                                             typename base::second_list,
-                                             typename type_list_push_front_impl<typename base::second_list, T>::type>;
+    template<typename Indices, typename... Types>
+    struct indexed_types;
+
+    template<std::size_t... Is, typename... Types>
+    struct indexed_types<std::index_sequence<Is...>, Types...> : indexed_type<Is, Types>... {};
+
+    // overload resolution deduces T from the only base with the requested index
+    template<std::size_t I, typename T>
+    indexed_type<I, T> type_at(const indexed_type<I, T>&);
+
+    template<template<typename...> typename List, typename Indexed, std::size_t Offset, typename Indices>
+    struct select_types;
+
+    template<template<typename...> typename List, typename Indexed, std::size_t Offset, std::size_t... Is>
+    struct select_types<List, Indexed, Offset, std::index_sequence<Is...>> {
+      using type = List<typename decltype(type_at<Offset + Is>(std::declval<Indexed>()))::type...>;
     };
 
   }  // namespace detail
@@ -92,9 +96,10 @@ namespace units {
   template<template<typename...> typename List, std::size_t N, typename... Types>
   struct type_list_split<List<Types...>, N> {
     static_assert(N <= sizeof...(Types), "Invalid index provided");
-    using split = detail::split_impl<List, 0, N, Types...>;
-    using first_list = typename split::first_list;
-    using second_list = typename split::second_list;
+    using indexed = detail::indexed_types<std::index_sequence_for<Types...>, Types...>;
+    using first_list = typename detail::select_types<List, indexed, 0, std::make_index_sequence<N>>::type;
+    using second_list =
+        typename detail::select_types<List, indexed, N, std::make_index_sequence<sizeof...(Types) - N>>::type;
   };
 
   // split_half
@@ -109,26 +114,34 @@ namespace units {
 
   namespace detail {
 
-    template<typename SortedList1, typename SortedList2, template<typename, typename> typename Pred>
-    struct type_list_merge_sorted_impl;
+    // an element of the first list is placed after every element of the second list it does not precede
+    template<template<typename, typename> typename Pred, typename T, typename... Others>
+    inline constexpr std::size_t count_not_preceded_by =
+        (std::size_t(0) + ... + std::size_t(!Pred<T, Others>::value));
 
-    template<template<typename...> typename List, typename... Lhs, template<typename, typename> typename Pred>
-    struct type_list_merge_sorted_impl<List<Lhs...>, List<>, Pred> {
-      using type = List<Lhs...>;
-    };
+    template<template<typename, typename> typename Pred, typename T, typename... Others>
+    inline constexpr std::size_t count_preceding = (std::size_t(0) + ... + std::size_t(Pred<Others, T>::value));
 
-    template<template<typename...> typename List, typename... Rhs, template<typename, typename> typename Pred>
-    struct type_list_merge_sorted_impl<List<>, List<Rhs...>, Pred> {
-      using type = List<Rhs...>;
-    };
+    template<typename LhsIndices, typename RhsIndices, typename SortedList1, typename SortedList2,
+             template<typename, typename> typename Pred>
+    struct merged_types;
+
+    template<std::size_t... Is, std::size_t... Js, template<typename...> typename List, typename... Lhs,
+             typename... Rhs, template<typename, typename> typename Pred>
+    struct merged_types<std::index_sequence<Is...>, std::index_sequence<Js...>, List<Lhs...>, List<Rhs...>, Pred> :
+        indexed_type<Is + count_not_preceded_by<Pred, Lhs, Rhs...>, Lhs>...,
+        indexed_type<Js + count_preceding<Pred, Rhs, Lhs...>, Rhs>... {};
+
+    template<typename SortedList1, typename SortedList2, template<typename, typename> typename Pred>
+    struct type_list_merge_sorted_impl;
 
-    template<template<typename...> typename List, typename Lhs1, typename... LhsRest, typename Rhs1, typename... RhsRest,
+    template<template<typename...> typename List, typename... Lhs, typename... Rhs,
              template<typename, typename> typename Pred>
-    struct type_list_merge_sorted_impl<List<Lhs1, LhsRest...>, List<Rhs1, RhsRest...>, Pred> {
-      using type = std::conditional_t<
-          Pred<Lhs1, Rhs1>::value,
-          typename type_list_push_front_impl<typename type_list_merge_sorted_impl<List<LhsRest...>, List<Rhs1, RhsRest...>, Pred>::type, Lhs1>::type,
-          typename type_list_push_front_impl<typename type_list_merge_sorted_impl<List<Lhs1, LhsRest...>, List<RhsRest...>, Pred>::type, Rhs1>::type>;
+    struct type_list_merge_sorted_impl<List<Lhs...>, List<Rhs...>, Pred> {
+      using merged = merged_types<std::index_sequence_for<Lhs...>, std::index_sequence_for<Rhs...>, List<Lhs...>,
+                                  List<Rhs...>, Pred>;
+      using type =
+          typename select_types<List, merged, 0, std::make_index_sequence<sizeof...(Lhs) + sizeof...(Rhs)>>::type;
     };
 
   }
@@ -0,0 +1,197 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "base_dimensions.h"
+#include "frequency.h"
+#include "length.h"
+#include "time.h"
+#include "velocity.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace units {
+
+  // base_dimension_symbol
+
+  template<typename BaseDimension>
+  inline constexpr std::string_view base_dimension_symbol{};
+
+  template<> inline constexpr std::string_view base_dimension_symbol<base_dim_length> = "m";
+  template<> inline constexpr std::string_view base_dimension_symbol<base_dim_mass> = "kg";
+  template<> inline constexpr std::string_view base_dimension_symbol<base_dim_time> = "s";
+
+  // dimension_symbol_name
+
+  // named coherent units of derived dimensions; other derived dimensions are spelled by their exponents ("m/s")
+  template<typename Dimension>
+  inline constexpr std::string_view dimension_symbol_name{};
+
+  template<> inline constexpr std::string_view dimension_symbol_name<dimension_frequency> = "Hz";
+
+  namespace detail {
+
+    // symbol_text
+
+    struct symbol_text {
+      char data[48] = {};
+      std::size_t size = 0;
+
+      constexpr void append(std::string_view str)
+      {
+        for(char c : str) data[size++] = c;
+      }
+
+      constexpr void append(std::intmax_t value)
+      {
+        char digits[20] = {};
+        std::size_t count = 0;
+        const bool negative = value < 0;
+        std::uintmax_t v = negative ? 0 - static_cast<std::uintmax_t>(value) : static_cast<std::uintmax_t>(value);
+        do {
+          digits[count++] = static_cast<char>('0' + v % 10);
+          v /= 10;
+        } while(v != 0);
+        if(negative) data[size++] = '-';
+        while(count != 0) data[size++] = digits[--count];
+      }
+
+      constexpr std::string_view view() const { return std::string_view(data, size); }
+    };
+
+    // SI prefix of a ratio of 10^k, empty if there is none
+    constexpr std::string_view si_prefix(std::intmax_t num, std::intmax_t den)
+    {
+      if(den == 1) {
+        switch(num) {
+          case 1'000: return "k";
+          case 1'000'000: return "M";
+          case 1'000'000'000: return "G";
+          case 1'000'000'000'000: return "T";
+          case 1'000'000'000'000'000: return "P";
+          case 1'000'000'000'000'000'000: return "E";
+        }
+      }
+      else if(num == 1) {
+        switch(den) {
+          case 1'000: return "m";
+          case 1'000'000: return "u";
+          case 1'000'000'000: return "n";
+          case 1'000'000'000'000: return "p";
+          case 1'000'000'000'000'000: return "f";
+          case 1'000'000'000'000'000'000: return "a";
+        }
+      }
+      return {};
+    }
+
+    template<typename E>
+    constexpr void append_factor(symbol_text& text, bool& first, int exponent)
+    {
+      if(!first) text.append("*");
+      first = false;
+      text.append(base_dimension_symbol<typename E::dimension>);
+      if(exponent != 1) {
+        text.append("^");
+        text.append(exponent);
+      }
+    }
+
+    // "m", "m/s", "m^2", "kg*m/s^2", "1/(m*s)"
+    template<typename Dimension>
+    struct dimension_symbol_impl;
+
+    template<typename... Es>
+    struct dimension_symbol_impl<dimension<Es...>> {
+      static constexpr symbol_text make()
+      {
+        symbol_text text;
+        bool first = true;
+        ((Es::value > 0 ? append_factor<Es>(text, first, Es::value) : void()), ...);
+        constexpr std::size_t negative = (std::size_t(0) + ... + std::size_t(Es::value < 0));
+        if constexpr(negative > 0) {
+          if(first) text.append("1");
+          text.append(negative > 1 ? "/(" : "/");
+          first = true;
+          ((Es::value < 0 ? append_factor<Es>(text, first, -Es::value) : void()), ...);
+          if(negative > 1) text.append(")");
+        }
+        return text;
+      }
+    };
+
+    // a prefix is applied to named units and to the units of a single base dimension; the kilogram already carries one
+    template<typename Dimension>
+    inline constexpr bool prefixable_dimension = !dimension_symbol_name<Dimension>.empty();
+
+    template<typename BaseDimension>
+    inline constexpr bool prefixable_dimension<dimension<exp<BaseDimension, 1>>> =
+        base_dimension_symbol<BaseDimension> != base_dimension_symbol<base_dim_mass>;
+
+    template<typename Unit>
+    constexpr symbol_text make_unit_symbol()
+    {
+      using dim = typename Unit::dimension;
+      using ratio = typename Unit::ratio;
+      constexpr std::string_view prefix = si_prefix(ratio::num, ratio::den);
+
+      symbol_text text;
+      if constexpr(ratio::num != 1 || ratio::den != 1) {
+        if constexpr(!prefix.empty() && prefixable_dimension<dim>)
+          text.append(prefix);
+        else {
+          // "[1000/3600] m/s"
+          text.append("[");
+          text.append(ratio::num);
+          if(ratio::den != 1) {
+            text.append("/");
+            text.append(ratio::den);
+          }
+          text.append("] ");
+        }
+      }
+      if constexpr(!dimension_symbol_name<dim>.empty())
+        text.append(dimension_symbol_name<dim>);
+      else
+        text.append(dimension_symbol_impl<dim>::make().view());
+      return text;
+    }
+
+    template<typename Unit>
+    inline constexpr symbol_text unit_symbol_text = make_unit_symbol<Unit>();
+
+  }  // namespace detail
+
+  // unit_symbol
+
+  // generated from the dimension and the ratio of the unit; specialized for units without a derivable symbol
+  template<typename Unit>
+  inline constexpr std::string_view unit_symbol = detail::unit_symbol_text<Unit>.view();
+
+  template<> inline constexpr std::string_view unit_symbol<minute> = "min";
+  template<> inline constexpr std::string_view unit_symbol<hour> = "h";
+  template<> inline constexpr std::string_view unit_symbol<kilometer_per_hour> = "km/h";
+  template<> inline constexpr std::string_view unit_symbol<mile_per_hour> = "mi/h";
+
+}  // namespace units
@@ -0,0 +1,135 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Train IT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Interface of the `units` C++20 module. The library headers are parsed and the standard units are
+// instantiated once in the global module fragment; the public names are then exported the same way the
+// standard library module does it. Built only by the `units_module` target of ref/module/CMakeLists.txt.
+
+module;
+
+#include "../include/frequency.h"
+#include "../include/velocity.h"
+
+export module units;
+
+export namespace units {
+
+  // type_list.h
+  using units::type_list_merge_sorted;
+  using units::type_list_push_back;
+  using units::type_list_push_front;
+  using units::type_list_sort;
+  using units::type_list_split;
+  using units::type_list_split_half;
+
+  // dimension.h
+  using units::dim_id;
+  using units::dim_id_less;
+  using units::dim_invert;
+  using units::dimension;
+  using units::dimension_divide;
+  using units::dimension_multiply;
+  using units::exp;
+  using units::exp_invert;
+  using units::exp_less;
+  using units::is_dimension;
+  using units::make_dimension;
+  using units::merge_dimension;
+
+  // base_dimensions.h
+  using units::base_dim_length;
+  using units::base_dim_mass;
+  using units::base_dim_time;
+
+  // common_ratio.h, unit.h
+  using units::common_ratio;
+  using units::is_ratio;
+  using units::is_unit;
+  using units::unit;
+
+  // quantity.h
+  using units::common_quantity;
+  using units::is_quantity;
+  using units::quantity;
+  using units::quantity_cast;
+  using units::quantity_conversion;
+  using units::quantity_values;
+  using units::same_dim;
+  using units::treat_as_floating_point;
+
+  // length.h
+  using units::dimension_length;
+  using units::kilometre;
+  using units::metre;
+  using units::millimetre;
+
+  // time.h
+  using units::dimension_time;
+  using units::hour;
+  using units::microsecond;
+  using units::millisecond;
+  using units::minute;
+  using units::nanosecond;
+  using units::second;
+
+  // velocity.h
+  using units::dimension_velocity;
+  using units::kilometer_per_hour;
+  using units::meter_per_second;
+  using units::mile_per_hour;
+
+  // frequency.h
+  using units::dimension_frequency;
+  using units::gigahertz;
+  using units::hertz;
+  using units::kilohertz;
+  using units::megahertz;
+  using units::millihertz;
+  using units::terahertz;
+
+  inline namespace literals {
+
+    using units::literals::operator""_mm;
+    using units::literals::operator""_m;
+    using units::literals::operator""_km;
+
+    using units::literals::operator""_ns;
+    using units::literals::operator""_us;
+    using units::literals::operator""_ms;
+    using units::literals::operator""_s;
+    using units::literals::operator""_min;
+    using units::literals::operator""_h;
+
+    using units::literals::operator""_mps;
+    using units::literals::operator""_kmph;
+    using units::literals::operator""_mph;
+
+    using units::literals::operator""_mHz;
+    using units::literals::operator""_Hz;
+    using units::literals::operator""_kHz;
+    using units::literals::operator""_MHz;
+    using units::literals::operator""_GHz;
+    using units::literals::operator""_THz;
+
+  }  // namespace literals
+
+}  // namespace units
@@ -20,11 +20,33 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "latency_histogram.h"
 #include "length.h"
 #include "time.h"
 #include "frequency.h"
 #include "velocity.h"
+#include "quantity_algorithm.h"
+#include "quantity_array.h"
+#include "quantity_atomic.h"
+#include "quantity_charconv.h"
+#include "quantity_chrono.h"
+#include "quantity_csv.h"
+#include "quantity_expr.h"
+#include "quantity_file.h"
+#include "quantity_ring.h"
+#include "quantity_stats.h"
+#include "quantity_varint.h"
+#include "resampler.h"
+#include "sample_queue.h"
+#include "sharded_quantity.h"
+#include "tsc_clock.h"
+#include "unit_symbol.h"
+#include <array>
+#include <chrono>
+#include <future>
 #include <limits>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 
 namespace {
@@ -262,6 +284,50 @@ namespace {
   // static_assert(quantity_cast<int>(2_km).count() == 2000);  // should not compile
   static_assert(quantity_cast<quantity<metre, int>>(2_km).count() == 2000);
   static_assert(quantity_cast<quantity<kilometre, int>>(2000_m).count() == 2);
+  static_assert(quantity_cast<quantity<meter_per_second, std::int64_t>>(100_kmph).count() == 27);
+  static_assert(quantity_cast<quantity<meter_per_second, std::int64_t>>(-100_kmph).count() == -27);
+  static_assert(quantity_cast<quantity<second, std::int64_t>>(-1999_ms).count() == -1);
+  static_assert(quantity_cast<quantity<millisecond, std::int64_t>>(-1999999_ns).count() == -1);
+  static_assert(quantity_cast<quantity<meter_per_second, std::int64_t>>(
+                    quantity<kilometer_per_hour, std::int64_t>(std::numeric_limits<std::int64_t>::max())).count() ==
+                2562047788015215501);
+  static_assert(quantity_cast<quantity<meter_per_second, std::int64_t>>(
+                    quantity<kilometer_per_hour, std::int64_t>(-std::numeric_limits<std::int64_t>::max())).count() ==
+                -2562047788015215501);
+  static_assert(quantity_cast<quantity<meter_per_second, int>>(quantity<kilometer_per_hour, int>(-100)).count() == -27);
+  static_assert(detail::may_overflow_multiply<std::intmax_t, std::int64_t, 5>());
+  static_assert(!detail::may_overflow_multiply<std::intmax_t, std::int32_t, 5>());
+  static_assert(!detail::may_overflow_multiply<double, std::int64_t, 5>());
+
+  // const_division
+
+  template<std::intmax_t D>
+  constexpr bool divide_as_operator(std::int64_t n) { return detail::divide<D>(n) == n / D; }
+
+  template<std::intmax_t D>
+  constexpr bool divide_as_operator()
+  {
+    constexpr std::int64_t max = std::numeric_limits<std::int64_t>::max();
+    constexpr std::int64_t min = std::numeric_limits<std::int64_t>::min();
+    return divide_as_operator<D>(0) && divide_as_operator<D>(1) && divide_as_operator<D>(-1) &&
+           divide_as_operator<D>(D) && divide_as_operator<D>(-D) && divide_as_operator<D>(D - 1) &&
+           divide_as_operator<D>(1 - D) && divide_as_operator<D>(123456789) && divide_as_operator<D>(-123456789) &&
+           divide_as_operator<D>(max) && divide_as_operator<D>(min) && divide_as_operator<D>(min + 1);
+  }
+
+  static_assert(detail::select_divisor<std::int64_t, 1>() == detail::divisor_kind::one);
+  static_assert(detail::select_divisor<std::int64_t, 1024>() == detail::divisor_kind::power_of_two);
+  static_assert(detail::select_divisor<double, 18>() == detail::divisor_kind::generic);
+  static_assert(divide_as_operator<2>());
+  static_assert(divide_as_operator<3>());
+  static_assert(divide_as_operator<7>());
+  static_assert(divide_as_operator<18>());
+  static_assert(divide_as_operator<1024>());
+  static_assert(divide_as_operator<3600>());
+  static_assert(divide_as_operator<std::milli::den>());
+  static_assert(divide_as_operator<std::micro::den>());
+  static_assert(divide_as_operator<std::nano::den>());
+  static_assert(divide_as_operator<std::numeric_limits<std::int64_t>::max()>());
 
   // type_list_push_front
 
@@ -379,6 +445,14 @@ namespace {
   static_assert(std::is_same_v<make_dimension<e<0, 1>, e<1, 1>, e<0, -1>>, dimension<e<1, 1>>>);
   static_assert(std::is_same_v<make_dimension<e<0, 1>, e<1, 1>, e<0, -1>, e<1, -1>>, dimension<>>);
 
+  // merge_dimension
+
+  static_assert(std::is_same_v<merge_dimension<dimension<e<0, 1>, e<2, 1>>, dimension<e<1, 1>, e<2, -1>>>,
+                               dimension_multiply<dimension<e<0, 1>, e<2, 1>>, dimension<e<1, 1>, e<2, -1>>>>);
+  static_assert(std::is_same_v<merge_dimension<dimension_velocity, dimension_time>,
+                               dimension_multiply<dimension_velocity, dimension_time>>);
+  static_assert(std::is_same_v<merge_dimension<dimension<>, dimension<>>, dimension<>>);
+
   // dimension_multiply
 
   static_assert(std::is_same_v<dimension_multiply<dimension<e<0, 1>>, dimension<e<1, 1>>>,
@@ -389,6 +463,9 @@ namespace {
                                dimension<e<0, 1>, e<1, 2>, e<2, 1>>>);
   static_assert(std::is_same_v<dimension_multiply<dimension<e<0, 1>, e<1, 1>, e<2, 1>>, dimension<e<1, -1>>>,
                                dimension<e<0, 1>, e<2, 1>>>);
+  static_assert(std::is_same_v<dimension_multiply<dimension<>, dimension<>>, dimension<>>);
+  static_assert(std::is_same_v<dimension_multiply<dimension<exp<base_dim_time, -1>>, dimension<exp<base_dim_length, 1>>>,
+                               dimension<exp<base_dim_length, 1>, exp<base_dim_time, -1>>>);
 
   // dimension_divide
 
@@ -424,4 +501,412 @@ namespace {
   static_assert(10_Hz * 10_s == 100);
   static_assert(2_km / 2_kmph == 1_h);
 
+  // lazy expressions
+
+  static_assert(std::is_same_v<decltype(lazy(1_km) + 1_m + 1_mm)::quantity_type, decltype(1_km + 1_m + 1_mm)>);
+  static_assert(std::is_same_v<decltype(lazy(1_km) * 2 - 1.0_m)::quantity_type, decltype(1_km * 2 - 1.0_m)>);
+  static_assert(std::is_same_v<decltype(lazy(1_m) / 1_s)::quantity_type, decltype(1_m / 1_s)>);
+  static_assert((lazy(1_km) + 2_m + 3_mm).eval() == 1002003_mm);
+  static_assert(eval(1_km + (lazy(2_m) - 3_mm)) == 1001997_mm);
+  static_assert(eval(lazy(2_kmph) * 2_h + 1_m) == 4001_m);
+  static_assert(eval(2 * lazy(3_m) + 1_km / 1_s * 1_s) == 1006_m);
+  static_assert(eval(lazy(10_km) / 5_km) == 2);
+  static_assert(quantity<metre, std::int64_t>(lazy(1_km) - 1_m) == 999_m);
+//  static_assert(eval(lazy(1_m) + 1_s) == 1_m);  // should not compile
+
+  // quantity_span
+
+  constexpr quantity<metre, int> span_data[] = {quantity<metre, int>(1), quantity<metre, int>(2), quantity<metre, int>(3)};
+  constexpr quantity_span<const quantity<metre, int>> span(span_data);
+
+  static_assert(span.size() == 3);
+  static_assert(span[2] == 3_m);
+  static_assert(span.subspan(1, 2).size() == 2);
+  static_assert(span.subspan(1, 2)[0] == 2_m);
+  static_assert(std::is_same_v<decltype(span)::unit, metre>);
+  static_assert(std::is_same_v<decltype(span)::rep, int>);
+
+  // quantity_array
+
+  static_assert(std::is_same_v<decltype(quantity_array<metre>() + quantity_array<metre>()), quantity_array<metre>>);
+  static_assert(std::is_same_v<decltype(quantity_array<kilometre, int>() + quantity_array<metre, int>()), quantity_array<metre, int>>);
+  static_assert(std::is_same_v<decltype(quantity_array<metre, int>() - quantity_array<metre, float>()), quantity_array<metre, float>>);
+  static_assert(std::is_same_v<decltype(quantity_array<metre>() * 2), quantity_array<metre>>);
+  static_assert(std::is_same_v<decltype(2.0f * quantity_array<metre, int>()), quantity_array<metre, float>>);
+  static_assert(std::is_same_v<decltype(quantity_array<metre>() / 2), quantity_array<metre>>);
+  static_assert(std::is_same_v<decltype(1 / quantity_array<second>()), quantity_array<hertz>>);
+  static_assert(std::is_same_v<decltype(quantity_array<metre>() / quantity_array<second>()), quantity_array<meter_per_second>>);
+  static_assert(std::is_same_v<decltype(quantity_array<kilometer_per_hour>() * quantity_array<hour>()), quantity_array<kilometre>>);
+  static_assert(std::is_same_v<decltype(quantity_span<const quantity<metre>>() * quantity_array<metre>()),
+                               quantity_array<unit<dimension<exp<base_dim_length, 2>>, std::ratio<1>>>>);
+
+  // bulk quantity_cast
+
+  static_assert(std::is_same_v<decltype(quantity_cast<quantity<metre>>(std::declval<quantity_array<millimetre>&>())),
+                               quantity_span<quantity<metre>>>);
+  static_assert(std::is_same_v<decltype(quantity_cast<quantity<metre>>(std::declval<quantity_span<quantity<millimetre>>>())),
+                               quantity_span<quantity<metre>>>);
+  static_assert(std::is_void_v<decltype(quantity_cast<quantity<metre>>(quantity_array<millimetre>(), quantity_span<quantity<metre>>()))>);
+
+  // from_chars
+
+  template<typename Q>
+  constexpr Q parse(std::string_view str)
+  {
+    Q q{};
+    from_chars(str.data(), str.data() + str.size(), q);
+    return q;
+  }
+
+  template<typename Q>
+  constexpr std::from_chars_result parse_result(std::string_view str)
+  {
+    Q q{};
+    return from_chars(str.data(), str.data() + str.size(), q);
+  }
+
+  static_assert(parse<quantity<metre, std::int64_t>>("12.5 km") == 12500_m);
+  static_assert(parse<quantity<millisecond, std::int64_t>>("300ms") == 300_ms);
+  static_assert(parse<quantity<meter_per_second, std::int64_t>>("36 kmph") == 10_mps);
+  static_assert(parse<quantity<meter_per_second, std::int64_t>>("-36.9kmph") == -10_mps);
+  static_assert(parse<quantity<second, std::int64_t>>("1.5 h") == 5400_s);
+  static_assert(parse<quantity<meter_per_second, std::int64_t>>("36 km/h") == 10_mps);
+  static_assert(parse<quantity<meter_per_second, std::int64_t>>("10m/s") == 10_mps);
+  constexpr std::string_view trailing_suffix = "10 m/x";
+  static_assert(parse_result<quantity<metre>>(trailing_suffix).ptr == trailing_suffix.data() + 4);
+  static_assert(parse<quantity<nanosecond, std::int64_t>>("1.234567890123 s") == 1234567890_ns);
+  static_assert(parse<quantity<metre, std::int64_t>>("9223372036854775.807 km") == 9223372036854775807_m);
+  static_assert(parse<quantity<metre, double>>("0.3 km") == 300.0_m);
+  static_assert(parse<quantity<metre, double>>("1e-3km") == 1.0_m);
+  static_assert(parse<quantity<hertz, double>>("2.5 GHz") == 2.5_GHz);
+
+  static_assert(parse_result<quantity<metre>>("12.5 km, 13 km").ec == std::errc{});
+  static_assert(*parse_result<quantity<metre>>("12.5 km, 13 km").ptr == ',');
+  static_assert(parse_result<quantity<metre>>("km").ec == std::errc::invalid_argument);
+  static_assert(parse_result<quantity<metre>>("12 parsec").ec == std::errc::invalid_argument);
+  static_assert(parse_result<quantity<metre>>("12 s").ec == std::errc::argument_out_of_domain);
+  static_assert(parse_result<quantity<metre, std::int64_t>>("9223372036854775808 m").ec == std::errc::result_out_of_range);
+  static_assert(parse_result<quantity<metre, int>>("3000000 km").ec == std::errc::result_out_of_range);
+
+  // unit_symbol
+
+  static_assert(unit_symbol<metre> == "m");
+  static_assert(unit_symbol<kilometre> == "km");
+  static_assert(unit_symbol<microsecond> == "us");
+  static_assert(unit_symbol<minute> == "min");
+  static_assert(unit_symbol<meter_per_second> == "m/s");
+  static_assert(unit_symbol<kilometer_per_hour> == "km/h");
+  static_assert(unit_symbol<hertz> == "Hz");
+  static_assert(unit_symbol<megahertz> == "MHz");
+  static_assert(unit_symbol<unit<dimension<>, std::ratio<1>>> == "");
+  static_assert(unit_symbol<unit<dimension<exp<base_dim_length, 2>>, std::ratio<1>>> == "m^2");
+  static_assert(unit_symbol<unit<dimension<exp<base_dim_length, 2>>, std::kilo>> == "[1000] m^2");
+  static_assert(unit_symbol<unit<dimension<exp<base_dim_length, -1>, exp<base_dim_time, -1>>, std::ratio<1>>> == "1/(m*s)");
+  static_assert(unit_symbol<unit<dimension_time, std::ratio<1, 60>>> == "[1/60] s");
+  static_assert(unit_symbol<unit<dimension_multiply<dimension_velocity, dimension_velocity>, std::ratio<1>>> == "m^2/s^2");
+  static_assert(unit_symbol<unit<dimension_divide<dimension_length, dimension_frequency>, std::milli>> == "[1/1000] m*s");
+  static_assert(unit_symbol<unit<dimension<exp<base_dim_length, 1>, exp<base_dim_mass, 1>, exp<base_dim_time, -2>>,
+                                 std::ratio<1>>> == "m*kg/s^2");
+  static_assert(unit_symbol<unit<dimension<exp<base_dim_mass, 1>>, std::milli>> == "[1/1000] kg");
+
+  // column_header
+
+  static_assert(make_column_header<metre, double>().rep == column_rep::float64);
+  static_assert(make_column_header<nanosecond, std::int64_t>(42).count == 42);
+  static_assert(make_column_header<nanosecond, std::int64_t>().den == 1'000'000'000);
+  static_assert(make_column_header<kilometer_per_hour, float>().exponent_count == 2);
+  static_assert(make_column_header<kilometer_per_hour, float>().exponents[1].value == -1);
+  static_assert(check_column_header(make_column_header<kilometre, float>(), make_column_header<metre, double>()) == std::errc());
+  static_assert(check_column_header(make_column_header<second, double>(), make_column_header<metre, double>()) ==
+                std::errc::argument_out_of_domain);
+  static_assert(check_column_header(column_header(), make_column_header<metre, double>()) == std::errc::invalid_argument);
+  static_assert(detail::make_column_ratio(2, 2000, 1, 1000).num == 1 && detail::make_column_ratio(2, 2000, 1, 1000).den == 1);
+  static_assert(detail::make_column_ratio(6, 4, 1, 2).num == 3 && detail::make_column_ratio(6, 4, 1, 2).den == 1);
+
+  // csv_header_cell
+
+  static_assert(parse_csv_header_cell("speed[km/h]").name == "speed");
+  static_assert(parse_csv_header_cell("speed[km/h]").symbol == "km/h");
+  static_assert(parse_csv_header_cell(" \"t [ms]\"\r").name == "t");
+  static_assert(parse_csv_header_cell(" \"t [ms]\"\r").symbol == "ms");
+  static_assert(parse_csv_header_cell("name").name == "name");
+  static_assert(parse_csv_header_cell("name").symbol.empty());
+
+  // varint encoding
+
+  template<typename To, typename From, std::size_t N>
+  constexpr std::errc varint_round_trip(const From (&values)[N], const To (&expected)[N])
+  {
+    std::uint8_t buffer[max_varint_size(N)] = {};
+    const std::size_t size = varint_encode(quantity_span<const From>(values), buffer);
+    To out[N] = {};
+    const varint_decode_result r = varint_decode(buffer, buffer + size, quantity_span<To>(out));
+    if(r.ec != std::errc() || r.count != N || r.ptr != buffer + size) return r.ec != std::errc() ? r.ec : std::errc::io_error;
+    for(std::size_t i = 0; i < N; ++i)
+      if(out[i] != expected[i]) return std::errc::io_error;
+    return std::errc();
+  }
+
+  template<typename Q, std::size_t N>
+  constexpr std::size_t varint_size(const Q (&values)[N])
+  {
+    std::uint8_t buffer[max_varint_size(N)] = {};
+    return varint_encode(quantity_span<const Q>(values), buffer);
+  }
+
+  constexpr quantity<millisecond, std::int64_t> timestamps[] = {1000_ms, 1010_ms, 1005_ms, 1005_ms, 2000_ms};
+  constexpr quantity<microsecond, std::int64_t> timestamps_us[] = {1'000'000_us, 1'010'000_us, 1'005'000_us,
+                                                                    1'005'000_us, 2'000'000_us};
+  constexpr quantity<microsecond, std::int64_t> durations[] = {1'000'000_us, 1'010'000_us, 1'005'000_us};
+  constexpr std::int32_t min32 = std::numeric_limits<std::int32_t>::min();
+  constexpr std::int32_t max32 = std::numeric_limits<std::int32_t>::max();
+  constexpr quantity<millimetre, std::int32_t> extremes[] = {quantity<millimetre, std::int32_t>(min32),
+                                                             quantity<millimetre, std::int32_t>(max32),
+                                                             quantity<millimetre, std::int32_t>(-1)};
+  constexpr quantity<millimetre, std::int64_t> extremes64[] = {quantity<millimetre, std::int64_t>(min32),
+                                                               quantity<millimetre, std::int64_t>(max32),
+                                                               quantity<millimetre, std::int64_t>(-1)};
+
+  static_assert(detail::zigzag_encode(0) == 0 && detail::zigzag_encode(static_cast<std::uint64_t>(-1)) == 1 &&
+                detail::zigzag_encode(1) == 2);
+  static_assert(detail::zigzag_encode(static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::min())) ==
+                std::numeric_limits<std::uint64_t>::max());
+  static_assert(varint_size(timestamps) == 10 + (1 + 2 + 1) + (1 + 1 + 1) + (1 + 2));  // tag, 1000 +10 | -5 +0 | +995
+  static_assert(varint_round_trip(timestamps, timestamps) == std::errc());
+  static_assert(varint_round_trip(timestamps, timestamps_us) == std::errc());
+  static_assert(varint_round_trip(extremes, extremes) == std::errc());
+  static_assert(varint_round_trip(extremes, extremes64) == std::errc());
+  static_assert(varint_round_trip(extremes64, extremes) == std::errc());
+  static_assert(varint_round_trip(extremes64, durations) == std::errc::argument_out_of_domain);
+
+  constexpr std::size_t varint_array_round_trip()
+  {
+    std::array<quantity<millisecond, std::int64_t>, 3> values = {1000_ms, 1010_ms, 1005_ms};
+    std::uint8_t buffer[max_varint_size(3)] = {};
+    const std::size_t size = varint_encode(quantity_span<quantity<millisecond, std::int64_t>>(values.data(), 3), buffer);
+    std::array<quantity<microsecond, std::int64_t>, 3> out = {};
+    const varint_decode_result r = varint_decode(buffer, buffer + size, out);
+    return r.ec == std::errc() && out[2] == 1'005'000_us ? varint_encode(values, buffer) : 0;
+  }
+
+  constexpr quantity<millisecond, std::int64_t> timestamps3[] = {1000_ms, 1010_ms, 1005_ms};
+  static_assert(varint_array_round_trip() == varint_size(timestamps3));
+
+  // shm_ring
+
+  static_assert(alignof(detail::ring_control) == detail::ring_padding);
+  static_assert(sizeof(detail::ring_slot<quantity<nanosecond, std::int64_t>, ring_producers::single>) == 8);
+  static_assert(detail::ring_bytes<quantity<nanosecond, std::int64_t>, ring_producers::single>(0) % 64 == 0);
+  static_assert(detail::ring_bytes<quantity<nanosecond, std::int64_t>, ring_producers::multiple>(4) ==
+                detail::ring_bytes<quantity<nanosecond, std::int64_t>, ring_producers::multiple>(0) + 4 * 16);
+
+  // atomic quantity
+
+  template<typename A, typename Q, typename = void>
+  inline constexpr bool can_fetch_add = false;
+
+  template<typename A, typename Q>
+  inline constexpr bool can_fetch_add<A, Q, std::void_t<decltype(std::declval<A&>().fetch_add(std::declval<Q>()))>> =
+      true;
+
+  static_assert(std::atomic<quantity<metre, std::int64_t>>::is_always_lock_free);
+  static_assert(std::atomic<quantity<second, double>>::is_always_lock_free);
+  static_assert(can_fetch_add<std::atomic<quantity<metre, std::int64_t>>, quantity<kilometre, int>>);
+  static_assert(!can_fetch_add<std::atomic<quantity<metre, std::int64_t>>, quantity<millimetre, std::int64_t>>);
+  static_assert(!can_fetch_add<std::atomic<quantity<metre, std::int64_t>>, quantity<metre, double>>);
+  static_assert(!can_fetch_add<std::atomic<quantity<metre, std::int64_t>>, quantity<second, std::int64_t>>);
+  static_assert(can_fetch_add<std::atomic<quantity<second, double>>, quantity<millisecond, std::int64_t>>);
+
+  // sharded_quantity
+
+  template<typename S, typename Q, typename = void>
+  inline constexpr bool can_add = false;
+
+  template<typename S, typename Q>
+  inline constexpr bool can_add<S, Q, std::void_t<decltype(std::declval<S&>().add(std::declval<Q>()))>> = true;
+
+  static_assert(can_add<sharded_quantity<second, std::int64_t>, quantity<hour, int>>);
+  static_assert(!can_add<sharded_quantity<second, std::int64_t>, quantity<millisecond, std::int64_t>>);
+  static_assert(!can_add<sharded_quantity<second, std::int64_t>, quantity<metre, std::int64_t>>);
+
+  // reduce and transform_reduce
+
+  constexpr quantity<millimetre, std::int64_t> lengths[] = {
+      quantity<millimetre, std::int64_t>(std::numeric_limits<std::int64_t>::max()),
+      quantity<millimetre, std::int64_t>(std::numeric_limits<std::int64_t>::max()),
+      quantity<millimetre, std::int64_t>(-std::numeric_limits<std::int64_t>::max()),
+      quantity<millimetre, std::int64_t>(1)};
+  constexpr quantity<kilometer_per_hour, int> speeds[] = {quantity<kilometer_per_hour, int>(36),
+                                                          quantity<kilometer_per_hour, int>(72)};
+  constexpr quantity<hour, int> steps[] = {quantity<hour, int>(1), quantity<hour, int>(2)};
+  constexpr quantity<second, double> halves[] = {quantity<second, double>(0.5), quantity<second, double>(0.25),
+                                                 quantity<second, double>(0.125)};
+
+  static_assert(std::is_same_v<accumulator_rep<int>, std::int64_t>);
+  static_assert(std::is_same_v<accumulator_rep<std::int64_t>, detail::int128>);
+  static_assert(std::is_same_v<accumulator_rep<float>, double>);
+  static_assert(std::is_same_v<decltype(reduce(quantity_span(lengths))), quantity<millimetre, detail::int128>>);
+  static_assert(reduce(quantity_span(lengths)).count() == detail::int128(std::numeric_limits<std::int64_t>::max()) + 1);
+  static_assert(reduce(execution::unseq, quantity_span(halves)) == quantity<millisecond, double>(875));
+  static_assert(std::is_same_v<decltype(transform_reduce(quantity_span(speeds), quantity_span(steps)))::unit::dimension,
+                               dimension_length>);
+  static_assert(transform_reduce(quantity_span(speeds), quantity_span(steps)) ==
+                quantity<kilometre, std::int64_t>(180));
+  static_assert(transform_reduce(execution::unseq, quantity_span(halves),
+                                 [](quantity<second, double> t) { return t * 2; }) == quantity<second, double>(1.75));
+
+  constexpr std::array<quantity<second, double>, 3> halves_array = {halves[0], halves[1], halves[2]};
+  constexpr std::array<quantity<hour, int>, 2> steps_array = {steps[0], steps[1]};
+  static_assert(reduce(halves_array) == reduce(quantity_span(halves)));
+  static_assert(reduce(execution::unseq, halves_array) == quantity<millisecond, double>(875));
+  static_assert(transform_reduce(quantity_span(speeds), steps_array) == quantity<kilometre, std::int64_t>(180));
+  static_assert(transform_reduce(halves_array, [](quantity<second, double> t) { return t * 2; }) ==
+                quantity<second, double>(1.75));
+
+  // quantity_stats
+
+  using latency = quantity<nanosecond, std::int64_t>;
+
+  constexpr latency latencies[] = {latency(2), latency(4), latency(4), latency(4),
+                                   latency(5), latency(5), latency(7), latency(9)};
+
+  constexpr quantity_stats<nanosecond, std::int64_t> stats_of(std::size_t first, std::size_t last, bool batch)
+  {
+    quantity_stats<nanosecond, std::int64_t> s;
+    if(batch)
+      s.update(quantity_span<const latency>(latencies + first, last - first));
+    else
+      for(std::size_t i = first; i < last; ++i) s.update(latencies[i]);
+    return s;
+  }
+
+  constexpr bool same_stats(const quantity_stats<nanosecond, std::int64_t>& lhs,
+                            const quantity_stats<nanosecond, std::int64_t>& rhs)
+  {
+    return lhs.count() == rhs.count() && lhs.min() == rhs.min() && lhs.max() == rhs.max() &&
+           lhs.mean() == rhs.mean() && lhs.variance() == rhs.variance();
+  }
+
+  static_assert(std::is_same_v<quantity_stats<nanosecond, std::int64_t>::variance_type::unit::dimension,
+                               dimension_multiply<dimension_time, dimension_time>>);
+  static_assert(stats_of(0, 8, false).count() == 8);
+  static_assert(stats_of(0, 8, false).min() == latency(2) && stats_of(0, 8, false).max() == latency(9));
+  static_assert(stats_of(0, 8, false).mean() == quantity<nanosecond, double>(5));
+  static_assert(stats_of(0, 8, false).variance().count() == 4);
+  static_assert(stats_of(0, 8, false).sample_variance().count() == 32.0 / 7);
+  static_assert(stats_of(0, 8, false).stddev() == quantity<nanosecond, double>(2));
+  static_assert(same_stats(stats_of(0, 8, true), stats_of(0, 8, false)));
+  static_assert(same_stats(stats_of(0, 3, true) + stats_of(3, 8, false), stats_of(0, 8, false)));
+  static_assert(same_stats(stats_of(0, 0, true) + stats_of(0, 8, true), stats_of(0, 8, true)));
+
+  // latency_histogram
+
+  using histogram = latency_histogram<nanosecond, 7>;
+
+  constexpr bool bucket_bounds_hold(std::int64_t v)
+  {
+    const std::size_t i = histogram::bucket_index(latency(v));
+    return i < histogram::bucket_count && histogram::bucket_lower(i).count() <= v &&
+           v <= histogram::bucket_upper(i).count() &&
+           (histogram::bucket_upper(i).count() - histogram::bucket_lower(i).count()) * 128 <= v;
+  }
+
+  static_assert(histogram::bucket_count == 57 * 128);
+  static_assert(histogram::bucket_index(latency(-5)) == 0);
+  static_assert(histogram::bucket_index(latency(255)) == 255);
+  static_assert(histogram::bucket_index(latency(256)) == 256 && histogram::bucket_index(latency(257)) == 256);
+  static_assert(histogram::bucket_index(latency::max()) == histogram::bucket_count - 1);
+  static_assert(histogram::bucket_upper(histogram::bucket_count - 1) == latency::max());
+  static_assert(bucket_bounds_hold(0) && bucket_bounds_hold(255) && bucket_bounds_hold(256));
+  static_assert(bucket_bounds_hold(1'000) && bucket_bounds_hold(1'000'000'007));
+  static_assert(bucket_bounds_hold(123'456'789) && bucket_bounds_hold(std::numeric_limits<std::int64_t>::max() / 3));
+
+  // resampler
+
+  using sample_time = quantity<millisecond, std::int64_t>;
+  using sample_speed = quantity<meter_per_second, int>;
+
+  struct window_summary {
+    std::int64_t start, end;
+    std::size_t count;
+    double mean;
+    int min, max, last;
+  };
+
+  // samples every 100 ms with the value of their timestamp in decimetres per second, resampled in batches of 'batch'
+  template<typename Length>
+  constexpr std::array<window_summary, 4> resample(const Length& length, std::size_t batch)
+  {
+    sample_time times[12] = {};
+    sample_speed values[12] = {};
+    for(int i = 0; i < 12; ++i) {
+      times[i] = sample_time(i * 100);
+      values[i] = sample_speed(i);
+    }
+    std::array<window_summary, 4> out{};
+    std::size_t n = 0;
+    auto emit = [&](const auto& w) {
+      out[n++] = {w.start.count(), w.end.count(), w.count, w.mean.count(),
+                  w.min.count(),   w.max.count(), w.last.count()};
+    };
+    resampler<sample_speed> r(length);
+    for(std::size_t i = 0; i < 12; i += batch)
+      r.push(quantity_span<const sample_time>(times + i, batch), quantity_span<const sample_speed>(values + i, batch),
+             emit);
+    r.flush(emit);
+    return out;
+  }
+
+  constexpr bool same_windows(const std::array<window_summary, 4>& lhs, const std::array<window_summary, 4>& rhs)
+  {
+    for(std::size_t i = 0; i < 4; ++i)
+      if(lhs[i].start != rhs[i].start || lhs[i].end != rhs[i].end || lhs[i].count != rhs[i].count ||
+         lhs[i].mean != rhs[i].mean || lhs[i].min != rhs[i].min || lhs[i].max != rhs[i].max ||
+         lhs[i].last != rhs[i].last)
+        return false;
+    return true;
+  }
+
+  constexpr std::array<window_summary, 4> three_hertz = {
+      {{0, 334, 4, 1.5, 0, 3, 3},
+       {334, 667, 3, 5, 4, 6, 6},
+       {667, 1000, 3, 8, 7, 9, 9},
+       {1000, 1334, 2, 10.5, 10, 11, 11}}};
+
+  static_assert(same_windows(resample(quantity<hertz>(3), 12), three_hertz));
+  static_assert(same_windows(resample(quantity<hertz>(3), 3), three_hertz));
+  static_assert(same_windows(resample(quantity<millihertz, int>(3000), 1), three_hertz));
+  static_assert(resample(quantity<second, double>(0.5), 4)[1].start == 500);
+  static_assert(resample(quantity<hertz, double>(0.5), 4)[0].end == 2000);
+
+  // sample_queue
+
+  static_assert(std::is_convertible_v<decltype(1.0 / std::declval<quantity<second, double>>()), quantity<hertz, double>>);
+  static_assert(alignof(sample_queue<int>) == 128);
+
+  // tsc_clock
+
+  static_assert(std::is_same_v<decltype(tsc_clock::now()), quantity<nanosecond, std::int64_t>>);
+  static_assert(std::is_same_v<decltype(trace_event::duration), quantity<nanosecond, std::int64_t>>);
+
+  // quantity_chrono
+
+  static_assert(std::is_same_v<decltype(as_quantity(std::chrono::milliseconds(1))), quantity<millisecond, std::int64_t>>);
+  static_assert(std::is_same_v<decltype(as_duration(1_s)), std::chrono::duration<std::int64_t>>);
+  static_assert(std::is_convertible_v<std::chrono::nanoseconds, quantity<nanosecond, std::int64_t>>);
+  static_assert(std::is_convertible_v<quantity<nanosecond, std::int64_t>, std::chrono::nanoseconds>);
+  static_assert(std::is_convertible_v<std::chrono::seconds, quantity<millisecond, std::int64_t>>);
+  static_assert(std::is_convertible_v<quantity<second, std::int64_t>, std::chrono::milliseconds>);
+  static_assert(std::is_convertible_v<std::chrono::milliseconds, quantity<second, double>>);
+  static_assert(!std::is_convertible_v<std::chrono::milliseconds, quantity<second, std::int64_t>>);
+  static_assert(!std::is_convertible_v<quantity<millisecond, std::int64_t>, std::chrono::seconds>);
+  static_assert(!std::is_constructible_v<quantity<metre, std::int64_t>, std::chrono::seconds>);
+  static_assert(!std::is_constructible_v<std::chrono::seconds, quantity<metre, std::int64_t>>);
+  static_assert(quantity<millisecond, std::int64_t>(std::chrono::seconds(2)).count() == 2000);
+  static_assert(quantity<second, std::int64_t>(std::chrono::milliseconds(2500)).count() == 2);
+  static_assert(std::chrono::microseconds(3_ms).count() == 3000);
+  static_assert(std::chrono::seconds(3500_ms).count() == 3);
+  static_assert(std::chrono::nanoseconds(quantity<nanosecond, std::int64_t>(std::chrono::nanoseconds(42))).count() == 42);
+  static_assert(std::is_same_v<decltype(wait_for(std::declval<std::future<int>&>(), 1_ms)), std::future_status>);
+
 }  // namespace